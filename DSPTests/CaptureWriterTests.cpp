@@ -0,0 +1,193 @@
+// CaptureWriterTests.cpp
+// Checks that the capture writer switches files exactly on a sample rate
+// change, validates its rotation limits and never mixes or overwrites sessions.
+
+#include "TestSupport.hpp"
+#include "CaptureWriter.hpp"
+#include "M2DXKernel.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+using namespace M2DX;
+using Test::expect;
+
+namespace {
+
+struct WavFile {
+    uint32_t sampleRate = 0;
+    std::vector<float> samples;  // Interleaved stereo
+};
+
+uint32_t readLE32(const uint8_t* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+bool readWav(const std::filesystem::path& path, WavFile& wav) {
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) return false;
+    uint8_t header[44];
+    bool ok = std::fread(header, 1, sizeof(header), file) == sizeof(header);
+    if (ok) {
+        wav.sampleRate = readLE32(header + 24);
+        wav.samples.resize(readLE32(header + 40) / sizeof(float));
+        ok = std::fread(wav.samples.data(), sizeof(float), wav.samples.size(), file) == wav.samples.size();
+    }
+    std::fclose(file);
+    return ok;
+}
+
+/// Capture files in directory, in rotation order
+std::vector<std::filesystem::path> listFiles(const std::filesystem::path& directory) {
+    std::vector<std::filesystem::path> files;
+    for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+        if (entry.path().extension() == ".wav") files.push_back(entry.path());
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+/// A read never crosses a rate change, even when frames on both sides are queued
+void testReadStopsAtRateChange() {
+    CaptureRing ring(4096);
+    std::vector<float> left(1000);
+    std::vector<float> right(1000);
+    ring.write(left.data(), right.data(), 1000);
+    ring.markSampleRate(44100.0f);
+    ring.write(left.data(), right.data(), 800);
+
+    std::vector<float> chunk(4096 * CaptureRing::kChannels);
+    float sampleRate = 0.0f;
+    expect(!ring.popSampleRateChange(sampleRate), "no rate change before the old-rate frames");
+    expect(ring.read(chunk.data(), 4096) == 1000, "read stops at the rate change frame");
+    expect(ring.popSampleRateChange(sampleRate) && sampleRate == 44100.0f, "rate change is taken at its frame");
+    expect(ring.read(chunk.data(), 4096) == 800, "new-rate frames follow");
+}
+
+/// Frames rendered at the old rate stay in the old file
+void testRotatesOnRateChangeFrame(const std::filesystem::path& directory) {
+    std::filesystem::path sessionDirectory = directory / "rate";
+    std::filesystem::create_directory(sessionDirectory);
+
+    CaptureRing ring(1 << 14);
+    CaptureWriter writer(ring);
+    bool started = writer.start(sessionDirectory.string(), "rate", 48000.0f);
+    expect(started, "capture writer starts");
+    if (!started) return;
+
+    M2DXKernel kernel;
+    kernel.initialize(48000.0f);
+    kernel.setCaptureRing(&ring);
+
+    std::vector<float> left(1000);
+    std::vector<float> right(1000);
+    kernel.processBuffer(left.data(), right.data(), 1000);
+    kernel.initialize(44100.0f);
+    kernel.processBuffer(left.data(), right.data(), 500);
+    kernel.initialize(44100.0f);  // Same rate: no new file
+    kernel.processBuffer(left.data(), right.data(), 300);
+    kernel.setCaptureRing(nullptr);
+    writer.stop();
+    expect(!writer.hasWriteError(), "capture writer reports no error");
+
+    std::vector<std::filesystem::path> files = listFiles(sessionDirectory);
+    expect(files.size() == 2, "rate change starts exactly one new file");
+    if (files.size() != 2) return;
+
+    WavFile before;
+    WavFile after;
+    expect(readWav(files[0], before) && readWav(files[1], after), "read capture files");
+    expect(before.sampleRate == 48000 && before.samples.size() == 1000 * 2, "old-rate frames stay in the old file");
+    expect(after.sampleRate == 44100 && after.samples.size() == 800 * 2, "new file starts on the rate change frame");
+}
+
+void testRejectsTinyByteLimit(const std::filesystem::path& directory) {
+    CaptureRing ring(1024);
+    CaptureWriter writer(ring);
+    expect(!writer.start(directory.string(), "tiny", 48000.0f, {4, 0.0}),
+           "byte limit smaller than one frame is rejected");
+
+    // One frame per file with a time limit shorter than a frame: no underflow, no spin
+    std::filesystem::path sessionDirectory = directory / "single";
+    std::filesystem::create_directory(sessionDirectory);
+    bool started = writer.start(sessionDirectory.string(), "single", 48000.0f, {8, 1e-6});
+    expect(started, "one-frame byte limit is accepted");
+    if (!started) return;
+
+    std::vector<float> left(16, 0.5f);
+    std::vector<float> right(16, 0.5f);
+    ring.write(left.data(), right.data(), 16);
+    writer.stop();
+    expect(!writer.hasWriteError(), "one-frame files are written without error");
+    expect(writer.getFramesWritten() == 16, "every frame is written");
+    expect(listFiles(sessionDirectory).size() == 16, "each file holds one frame");
+}
+
+/// Restarting within the same second starts a new session instead of
+/// truncating the previous one, and frames left from a stopped session are dropped
+void testRestartKeepsSessions(const std::filesystem::path& directory) {
+    std::filesystem::path sessionDirectory = directory / "restart";
+    std::filesystem::create_directory(sessionDirectory);
+
+    CaptureRing ring(1024);
+    CaptureWriter writer(ring);
+    std::vector<float> left(16, 0.5f);
+    std::vector<float> right(16, 0.5f);
+
+    bool allStarted = true;
+    for (int session = 0; session < 3; ++session) {
+        allStarted &= writer.start(sessionDirectory.string(), "restart", 48000.0f);
+        ring.write(left.data(), right.data(), 16);
+        writer.stop();
+    }
+    expect(allStarted, "capture restarts immediately");
+
+    std::vector<std::filesystem::path> files = listFiles(sessionDirectory);
+    expect(files.size() == 3, "each session keeps its own file");
+    bool allKept = true;
+    for (const auto& file : files) {
+        WavFile wav;
+        allKept &= readWav(file, wav) && wav.samples.size() == 16 * 2;
+    }
+    expect(allKept, "earlier sessions are not truncated");
+
+    // Frames queued after the writer stopped were rendered at the old rate
+    std::filesystem::path staleDirectory = directory / "stale";
+    std::filesystem::create_directory(staleDirectory);
+    ring.write(left.data(), right.data(), 16);
+    ring.markSampleRate(44100.0f);
+    bool started = writer.start(staleDirectory.string(), "stale", 48000.0f);
+    expect(started, "capture starts over stale frames");
+    if (!started) return;
+    ring.write(left.data(), right.data(), 8);
+    writer.stop();
+
+    files = listFiles(staleDirectory);
+    WavFile wav;
+    expect(files.size() == 1 && readWav(files[0], wav), "stale frames do not start an extra file");
+    expect(wav.samples.size() == 8 * 2, "stale frames are discarded");
+    expect(wav.sampleRate == 44100, "rate change marked after the stale frames still applies");
+}
+
+} // namespace
+
+int main() {
+    char directoryTemplate[] = "/tmp/m2dx-capture-XXXXXX";
+    const char* directory = mkdtemp(directoryTemplate);
+    if (!directory) {
+        std::fprintf(stderr, "FAIL: cannot create capture directory\n");
+        return EXIT_FAILURE;
+    }
+
+    testReadStopsAtRateChange();
+    testRotatesOnRateChangeFrame(directory);
+    testRejectsTinyByteLimit(directory);
+    testRestartKeepsSessions(directory);
+
+    std::filesystem::remove_all(directory);
+    return Test::finish("capture writer");
+}
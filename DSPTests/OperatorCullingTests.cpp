@@ -0,0 +1,228 @@
+// OperatorCullingTests.cpp
+// Checks that operator culling only skips rendering: culled voices match a
+// reference that runs every operator of the routing every sample, and voices
+// whose carriers are culled are still allocated, released and freed.
+
+#include "TestSupport.hpp"
+#include "M2DXKernel.hpp"
+
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+using namespace M2DX;
+using Test::expect;
+
+namespace {
+
+constexpr float kSampleRate = 48000.0f;
+constexpr int kCullingBlockFrames = 64;
+constexpr uint8_t kNote = 57;
+constexpr uint8_t kVelocity = 100;
+/// The unrolled full-routing path may sum carriers in another order under
+/// -ffast-math; a skipped or misrouted operator is off by far more
+constexpr float kRoundingTolerance = 1e-6f;
+
+/// Unculled reference: every operator of the routing, every sample
+struct ReferenceVoice {
+    std::array<FMOperator, kNumOperators> operators;
+
+    float process(const AlgorithmRouting& routing) {
+        std::array<float, kNumOperators> outputs{};
+        float output = 0.0f;
+        for (const OperatorRoute& route : routing.routes) {
+            float modulation = 0.0f;
+            uint8_t modulators = route.modulators;
+            while (modulators != 0) {
+                modulation += outputs[__builtin_ctz(modulators)];
+                modulators &= modulators - 1;
+            }
+            float out = operators[route.op].process(modulation);
+            outputs[route.op] = out;
+            if (route.carrier) output += out;
+        }
+        return output * routing.outputScale;
+    }
+};
+
+/// Patch shared by the culled voice and the reference
+struct CullingCase {
+    int algorithm = 0;
+    uint8_t audible = DX7::kAllOperators;  // Operators with level > 0
+    bool fastModulatorRelease = false;     // Modulators go idle while carriers still ring
+};
+
+void configure(FMOperator& op, int index, const CullingCase& patch) {
+    op.setSampleRate(kSampleRate);
+    op.setRatio(1.0f + 0.5f * index);
+    op.setLevel((patch.audible & DX7::operatorBit(index)) ? 1.0f - 0.1f * index : 0.0f);
+    op.setFeedback(index == 5 ? 0.3f : 0.0f);
+    op.setEnvelopeLevels(1.0f, 0.8f, 0.6f, 0.0f);
+}
+
+/// Render a note through its release on a culled Voice and on the reference
+bool culledMatchesReference(const CullingCase& patch) {
+    const AlgorithmRouting& routing = DX7::getAlgorithmRouting(patch.algorithm);
+
+    std::array<OperatorScaling, kNumOperators> scaling;
+    for (int op = 0; op < kNumOperators; ++op) {
+        bool carrier = false;
+        for (const auto& route : routing.routes) {
+            if (route.op == op) carrier = route.carrier;
+        }
+        float release = patch.fastModulatorRelease && !carrier ? 99.0f : 80.0f;
+        scaling[op].setSampleRate(kSampleRate);
+        scaling[op].setEnvelopeRates(99.0f, 80.0f, 70.0f, release);
+    }
+
+    Voice voice;
+    ReferenceVoice reference;
+    voice.setSampleRate(kSampleRate);
+    voice.setSchedule(DX7::buildOperatorSchedule(patch.algorithm, patch.audible));
+    for (int op = 0; op < kNumOperators; ++op) {
+        configure(voice.getOperator(op), op, patch);
+        configure(reference.operators[op], op, patch);
+    }
+
+    float frequency = 440.0f * std::pow(2.0f, (kNote - 69) / 12.0f);
+    voice.noteOn(kNote, kVelocity, frequency, scaling);
+    for (int op = 0; op < kNumOperators; ++op) {
+        reference.operators[op].setEnvelopeCoefficients(scaling[op].getEnvelopeCoefficients(kNote));
+        reference.operators[op].noteOn(frequency, scaling[op].getNoteGain(kNote, kVelocity));
+    }
+
+    constexpr int kNoteOffFrame = 2048;
+    constexpr int kTotalFrames = 16384;
+    for (int frame = 0; frame < kTotalFrames; ++frame) {
+        if (frame == kNoteOffFrame) {
+            voice.noteOff();
+            for (auto& op : reference.operators) op.noteOff();
+        }
+        if (frame % kCullingBlockFrames == 0) voice.updateLiveOperators();
+        float expected = reference.process(routing);
+        float actual = voice.isActive() ? voice.process() : 0.0f;
+        if (std::abs(actual - expected) > kRoundingTolerance) {
+            std::fprintf(stderr, "algorithm %d audible 0x%02x: frame %d differs (%g vs %g)\n",
+                         patch.algorithm + 1, patch.audible, frame, actual, expected);
+            return false;
+        }
+    }
+
+    bool referenceActive = false;
+    for (const auto& op : reference.operators) referenceActive |= op.isActive();
+    if (voice.isActive() != referenceActive) {
+        std::fprintf(stderr, "algorithm %d audible 0x%02x: voice activity differs after release\n",
+                     patch.algorithm + 1, patch.audible);
+        return false;
+    }
+    return true;
+}
+
+/// Kernel on algorithm 1 (OP1 is the only carrier) with fast envelopes
+std::unique_ptr<M2DXKernel> makeKernel() {
+    auto kernel = std::make_unique<M2DXKernel>();
+    kernel->initialize(kSampleRate);
+    kernel->setAlgorithm(0);
+    for (int op = 0; op < kNumOperators; ++op) {
+        kernel->setOperatorEnvelopeRates(op, 99.0f, 99.0f, 99.0f, 99.0f);
+    }
+    return kernel;
+}
+
+/// Render seconds of audio and report whether any of it was non-zero
+bool render(M2DXKernel& kernel, float seconds) {
+    std::vector<float> left(256);
+    std::vector<float> right(256);
+    bool audible = false;
+    for (int frames = static_cast<int>(seconds * kSampleRate); frames > 0; frames -= 256) {
+        kernel.processBuffer(left.data(), right.data(), 256);
+        for (float sample : left) audible |= sample != 0.0f;
+    }
+    return audible;
+}
+
+void testMatchesUnculledReference() {
+    bool allMatch = true;
+    for (int algorithm = 0; algorithm < kNumAlgorithms; ++algorithm) {
+        CullingCase patch;
+        patch.algorithm = algorithm;
+        allMatch &= culledMatchesReference(patch);
+
+        // Each operator at level 0 in turn, and the upper half of the stack at once
+        for (int op = 0; op < kNumOperators; ++op) {
+            patch.audible = static_cast<uint8_t>(DX7::kAllOperators & ~DX7::operatorBit(op));
+            allMatch &= culledMatchesReference(patch);
+        }
+        patch.audible = 0x07;
+        allMatch &= culledMatchesReference(patch);
+
+        patch.audible = DX7::kAllOperators;
+        patch.fastModulatorRelease = true;
+        allMatch &= culledMatchesReference(patch);
+    }
+    expect(allMatch, "culled schedules match the unculled reference on every algorithm");
+}
+
+/// A ramp that brings a silent carrier back must sound in the same buffer
+void testRampReschedulesWithinBlock() {
+    auto kernel = makeKernel();
+    kernel->noteOn(60, 100);
+    kernel->setOperatorLevel(0, 0.0f);
+    render(*kernel, 0.01f);
+
+    std::vector<float> left(256);
+    std::vector<float> right(256);
+    kernel->scheduleParameterRamp(DX7::getOperatorLevelAddress(0), 1.0f, 100, 0);
+    kernel->processBuffer(left.data(), right.data(), 256);
+    bool silentBefore = true;
+    bool audibleAfter = false;
+    for (int i = 0; i < 256; ++i) {
+        if (i < 100) silentBefore &= left[i] == 0.0f;
+        else audibleAfter |= left[i] != 0.0f;
+    }
+    expect(silentBefore, "culled carrier is silent before the ramp");
+    expect(audibleAfter, "carrier is rescheduled at the ramp frame, not the next block");
+}
+
+void testReleaseWhileCarrierCulled() {
+    auto kernel = makeKernel();
+    kernel->noteOn(60, 100);
+    render(*kernel, 0.1f);
+
+    kernel->setOperatorLevel(0, 0.0f);
+    kernel->noteOff(60);
+    render(*kernel, 2.0f);
+    expect(kernel->getActiveVoiceCount() == 0, "note released while its carrier is culled frees the voice");
+
+    kernel->setOperatorLevel(0, 1.0f);
+    expect(!render(*kernel, 0.1f), "restoring the carrier level does not resurrect the released note");
+}
+
+void testAllocationWhileCarrierCulled() {
+    auto kernel = makeKernel();
+    kernel->setOperatorLevel(0, 0.0f);
+    kernel->noteOn(60, 100);
+    kernel->noteOn(64, 100);
+    kernel->noteOn(67, 100);
+    render(*kernel, 0.01f);
+    expect(kernel->getActiveVoiceCount() == 3, "silent notes get their own voices");
+
+    kernel->setOperatorLevel(0, 1.0f);
+    expect(render(*kernel, 0.01f), "held notes sound once the carrier is restored");
+
+    kernel->allNotesOff();
+    render(*kernel, 2.0f);
+    expect(kernel->getActiveVoiceCount() == 0, "all notes off frees every voice");
+}
+
+} // namespace
+
+int main() {
+    testMatchesUnculledReference();
+    testRampReschedulesWithinBlock();
+    testReleaseWhileCarrierCulled();
+    testAllocationWhileCarrierCulled();
+    return Test::finish("operator culling");
+}
@@ -0,0 +1,111 @@
+// OperatorScalingTests.cpp
+// Checks the keyboard level scaling, velocity and rate scaling tables against
+// values worked out by hand from the Dexed integer formulas.
+
+#include "TestSupport.hpp"
+#include "OperatorScaling.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace M2DX;
+using Test::expect;
+
+namespace {
+
+constexpr float kSampleRate = 48000.0f;
+
+/// Linear gain of a level offset in DX7 output level steps
+float stepsToGain(float steps) {
+    return std::pow(10.0f, steps * DX7::kOutputLevelStepDB / 20.0f);
+}
+
+bool near(float actual, float expected) {
+    return std::abs(actual - expected) <= 1e-5f * std::max(1.0f, std::abs(expected));
+}
+
+float levelGain(const OperatorScaling& scaling, int note) {
+    return scaling.getNoteGain(static_cast<uint8_t>(note), 127);
+}
+
+void testLevelScalingAroundBreakPoint() {
+    // Break point 39 (C3): the curves start 17 notes above it, at MIDI note 56
+    OperatorScaling scaling;
+    scaling.setKeyboardLevelScaling(39, 99, 99, ScalingCurve::NegativeLinear, ScalingCurve::PositiveLinear);
+
+    expect(levelGain(scaling, 56) == 1.0f, "no level offset on the break point");
+    expect(levelGain(scaling, 57) == 1.0f, "first note above the break point is unscaled");
+    expect(levelGain(scaling, 55) == 1.0f, "first note below the break point is unscaled");
+
+    // Group 1 at depth 99: (1 * 99 * 329) >> 12 = 7 steps
+    expect(near(levelGain(scaling, 58), stepsToGain(7.0f)), "positive linear curve above the break point");
+    expect(near(levelGain(scaling, 54), stepsToGain(-7.0f)), "negative linear curve below the break point");
+    expect(levelGain(scaling, 53) == levelGain(scaling, 54), "notes in the same group share a level");
+
+    // Note 0 is group 19 on the left: (19 * 50 * 329) >> 12 = 76 steps
+    scaling.setKeyboardLevelScaling(39, 50, 0, ScalingCurve::NegativeLinear, ScalingCurve::NegativeLinear);
+    expect(near(levelGain(scaling, 0), stepsToGain(-76.0f)), "linear depth scales with distance");
+    expect(levelGain(scaling, 127) == 1.0f, "zero right depth leaves the upper keyboard alone");
+
+    // Group 10 on the exponential curve: (11 * 99 * 329) >> 15 = 10 steps
+    scaling.setKeyboardLevelScaling(39, 0, 99, ScalingCurve::NegativeLinear, ScalingCurve::NegativeExponential);
+    expect(near(levelGain(scaling, 85), stepsToGain(-10.0f)), "negative exponential curve");
+    scaling.setKeyboardLevelScaling(39, 0, 99, ScalingCurve::NegativeLinear, ScalingCurve::PositiveExponential);
+    expect(near(levelGain(scaling, 85), stepsToGain(10.0f)), "positive exponential curve");
+
+    // Moving the break point moves the curve with it
+    scaling.setKeyboardLevelScaling(60, 99, 99, ScalingCurve::NegativeLinear, ScalingCurve::PositiveLinear);
+    expect(levelGain(scaling, 77) == 1.0f && levelGain(scaling, 79) > 1.0f, "curve follows the break point");
+}
+
+void testVelocityGain() {
+    OperatorScaling scaling;
+    expect(scaling.getNoteGain(60, 1) == 1.0f && scaling.getNoteGain(60, 127) == 1.0f,
+           "sensitivity 0 ignores velocity");
+
+    scaling.setVelocitySensitivity(7);
+    // (((7 * (254 - 239) + 7) >> 3) << 4) / 32 = 7 steps
+    expect(near(scaling.getNoteGain(60, 127), stepsToGain(7.0f)), "velocity 127 at sensitivity 7");
+    // (((7 * (206 - 239) + 7) >> 3) << 4) / 32 = -14 steps
+    expect(near(scaling.getNoteGain(60, 64), stepsToGain(-14.0f)), "velocity 64 at sensitivity 7");
+    // (((7 * (0 - 239) + 7) >> 3) << 4) / 32 = -104.5 steps
+    expect(near(scaling.getNoteGain(60, 1), stepsToGain(-104.5f)), "velocity 1 at sensitivity 7");
+
+    scaling.setVelocitySensitivity(3);
+    // (((3 * 15 + 7) >> 3) << 4) / 32 = 3 steps
+    expect(near(scaling.getNoteGain(60, 127), stepsToGain(3.0f)), "velocity 127 at sensitivity 3");
+}
+
+void testRateScalingGroups() {
+    OperatorScaling scaling;
+    scaling.setSampleRate(kSampleRate);
+    scaling.setEnvelopeRates(50.0f, 40.0f, 30.0f, 20.0f);
+
+    const auto& low = scaling.getEnvelopeCoefficients(21);
+    const auto& high = scaling.getEnvelopeCoefficients(127);
+    expect(low == high, "rate scaling 0 gives every note the same envelope");
+    expect(near(low[0], Envelope::rateToCoefficient(50.0f, kSampleRate)), "unscaled rate matches the envelope curve");
+
+    scaling.setRateScaling(7);
+    // Group = note / 3 - 7; the rate gains (7 * group) >> 3 internal steps of 99 / 63
+    auto expectedCoefficient = [](float rate, int group) {
+        float delta = static_cast<float>((7 * group) >> 3) * 99.0f / 63.0f;
+        return Envelope::rateToCoefficient(std::min(rate + delta, DX7::kEnvelopeMaxRate), kSampleRate);
+    };
+    expect(near(scaling.getEnvelopeCoefficients(21)[0], expectedCoefficient(50.0f, 0)), "group 0 is unscaled");
+    expect(near(scaling.getEnvelopeCoefficients(60)[0], expectedCoefficient(50.0f, 13)), "middle C is group 13");
+    expect(near(scaling.getEnvelopeCoefficients(127)[3], expectedCoefficient(20.0f, 31)), "top notes clamp to group 31");
+    expect(scaling.getEnvelopeCoefficients(60) == scaling.getEnvelopeCoefficients(62), "notes share a group by three");
+    expect(scaling.getEnvelopeCoefficients(63)[0] > scaling.getEnvelopeCoefficients(60)[0],
+           "higher groups run faster");
+    expect(scaling.getEnvelopeCoefficients(0) == scaling.getEnvelopeCoefficients(21), "notes below C1 are group 0");
+}
+
+} // namespace
+
+int main() {
+    testLevelScalingAroundBreakPoint();
+    testVelocityGain();
+    testRateScalingGroups();
+    return Test::finish("operator scaling");
+}
@@ -0,0 +1,215 @@
+// ParameterRampTests.cpp
+// Checks ParameterRamp curves and the timing of scheduleParameterRamp()
+// against a reference kernel rendering the same note without automation.
+
+#include "TestSupport.hpp"
+#include "M2DXKernel.hpp"
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+using namespace M2DX;
+using Test::expect;
+
+namespace {
+
+constexpr int kBlockFrames = 256;
+constexpr float kVolume = 0.5f;
+
+/// Kernel holding one sustained note on algorithm 32 (every operator a carrier)
+std::unique_ptr<M2DXKernel> makeSustainedKernel() {
+    auto kernel = std::make_unique<M2DXKernel>();
+    kernel->initialize(48000.0f);
+    kernel->setAlgorithm(31);
+    kernel->setMasterVolume(kVolume);
+    for (int op = 0; op < kNumOperators; ++op) {
+        kernel->setOperatorRatio(op, static_cast<float>(op + 1));
+        kernel->setOperatorEnvelopeRates(op, 99.0f, 99.0f, 99.0f, 99.0f);
+        kernel->setOperatorEnvelopeLevels(op, 1.0f, 1.0f, 1.0f, 0.0f);
+    }
+    kernel->noteOn(57, 100);
+
+    std::vector<float> left(4096);
+    std::vector<float> right(4096);
+    kernel->processBuffer(left.data(), right.data(), 4096);
+    return kernel;
+}
+
+/// Automated kernel and an untouched reference rendered block by block
+struct RampHarness {
+    std::unique_ptr<M2DXKernel> kernel = makeSustainedKernel();
+    std::unique_ptr<M2DXKernel> reference = makeSustainedKernel();
+    std::vector<float> output = std::vector<float>(kBlockFrames);
+    std::vector<float> expected = std::vector<float>(kBlockFrames);
+    std::vector<float> scratch = std::vector<float>(kBlockFrames);
+
+    void render() {
+        kernel->processBuffer(output.data(), scratch.data(), kBlockFrames);
+        reference->processBuffer(expected.data(), scratch.data(), kBlockFrames);
+    }
+
+    /// output == expected * gain on frames [begin, end)
+    bool matches(int begin, int end, float gain) const {
+        for (int i = begin; i < end; ++i) {
+            if (output[i] != expected[i] * gain) return false;
+        }
+        return true;
+    }
+
+    bool silent(int begin, int end) const {
+        for (int i = begin; i < end; ++i) {
+            if (output[i] != 0.0f) return false;
+        }
+        return true;
+    }
+};
+
+void testRampCurves() {
+    ParameterRamp ramp;
+    ramp.reset(0.0f);
+    ramp.start(1.0f, 100, RampShape::Linear);
+    ramp.advance(99);
+    expect(ramp.isRamping() && ramp.getValue() < 1.0f, "linear ramp still moving one frame before its end");
+    ramp.advance(1);
+    expect(!ramp.isRamping() && ramp.getValue() == 1.0f, "linear ramp lands exactly on its target");
+
+    ramp.reset(1.0f);
+    ramp.start(100.0f, 2, RampShape::Exponential);
+    expect(std::abs(ramp.advance(1) - 10.0f) < 1e-4f, "exponential ramp is geometric");
+
+    // Exponential segments crossing zero fall back to linear
+    ramp.reset(-10.0f);
+    ramp.start(10.0f, 20, RampShape::Exponential);
+    float middle = ramp.advance(10);
+    expect(std::isfinite(middle) && std::abs(middle) < 1e-5f, "exponential ramp across zero is linear");
+    expect(ramp.advance(10) == 10.0f, "exponential fallback reaches its target");
+
+    ramp.reset(0.0f);
+    ramp.start(1.0f, 0, RampShape::Linear);
+    expect(!ramp.isRamping() && ramp.getValue() == 1.0f, "zero-length ramp is a step");
+}
+
+void testStepAtFrameOffset() {
+    RampHarness harness;
+    harness.kernel->scheduleParameterRamp(DX7::kMasterVolumeAddress, kVolume * 0.5f, 100, 0);
+    harness.render();
+    expect(harness.matches(0, 100, 1.0f), "volume unchanged before the step offset");
+    expect(harness.matches(100, kBlockFrames, 0.5f), "volume step lands on its frame offset");
+
+    RampHarness levels;
+    for (int op = 0; op < kNumOperators; ++op) {
+        levels.kernel->scheduleParameterRamp(DX7::getOperatorLevelAddress(op), 0.0f, 37, 0);
+    }
+    levels.render();
+    expect(levels.matches(0, 37, 1.0f), "operator levels unchanged before the step offset");
+    expect(levels.silent(37, kBlockFrames), "operator level step lands on its frame offset");
+}
+
+void testLinearEndpoint() {
+    constexpr int offset = 50;
+    constexpr int duration = 100;
+
+    RampHarness harness;
+    harness.kernel->scheduleParameterRamp(DX7::kMasterVolumeAddress, kVolume * 0.5f, offset, duration);
+    harness.render();
+    expect(harness.matches(0, offset, 1.0f), "volume ramp starts at its frame offset");
+    expect(!harness.matches(offset, offset + duration, 0.5f), "volume moves during the ramp");
+    expect(harness.matches(offset + duration, kBlockFrames, 0.5f), "volume ramp ends at offset + duration");
+
+    // A short operator fade must actually fade rather than jump at its start
+    RampHarness levels;
+    for (int op = 0; op < kNumOperators; ++op) {
+        levels.kernel->scheduleParameterRamp(DX7::getOperatorLevelAddress(op), 0.0f, offset, 16);
+    }
+    levels.render();
+    expect(levels.matches(0, offset, 1.0f), "level fade starts at its frame offset");
+    expect(!levels.silent(offset, offset + 16), "16-frame level fade is audible while it runs");
+    expect(levels.silent(offset + 16, kBlockFrames), "level fade is silent from offset + duration");
+}
+
+void testCarryOver() {
+    RampHarness harness;
+    harness.kernel->scheduleParameterRamp(DX7::kMasterVolumeAddress, kVolume * 0.5f, kBlockFrames + 44, 0);
+    harness.render();
+    expect(harness.matches(0, kBlockFrames, 1.0f), "event past the buffer leaves the first buffer alone");
+    expect(harness.kernel->isRamping(), "event past the buffer stays queued");
+    harness.render();
+    expect(harness.matches(0, 44, 1.0f), "carried event waits for its frame");
+    expect(harness.matches(44, kBlockFrames, 0.5f), "carried event lands on its frame in the next buffer");
+    expect(!harness.kernel->isRamping(), "queue drains after the carried event");
+}
+
+void testSetterCancelsRamp() {
+    RampHarness harness;
+    harness.kernel->scheduleParameterRamp(DX7::kMasterVolumeAddress, 0.0f, 0, 100000);
+    harness.render();
+    harness.kernel->setMasterVolume(kVolume);
+    expect(!harness.kernel->isRamping(), "immediate setter cancels the ramp");
+    harness.render();
+    expect(harness.matches(0, kBlockFrames, 1.0f), "cancelled ramp no longer moves the value");
+
+    RampHarness posted;
+    int address = DX7::getOperatorRatioAddress(2);
+    posted.kernel->scheduleParameterRamp(address, 8.0f, 0, 100000);
+    posted.reference->scheduleParameterRamp(address, 8.0f, 0, 100000);
+    posted.render();
+    posted.kernel->postParameter(address, 3.0f);
+    posted.reference->setOperatorRatio(2, 3.0f);
+    posted.render();
+    expect(!posted.kernel->isRamping(), "posted value cancels the ramp at the next render");
+    expect(posted.matches(0, kBlockFrames, 1.0f), "posted value applies at the start of the next render");
+}
+
+/// Feedback and EG changes posted from another thread match the direct setters
+void testPostedNonRampableParameters() {
+    RampHarness harness;
+    harness.kernel->postParameter(DX7::getOperatorFeedbackAddress(5), 0.6f);
+    harness.reference->setOperatorFeedback(5, 0.6f);
+    harness.kernel->postOperatorEnvelopeLevels(1, 1.0f, 0.5f, 0.25f, 0.0f);
+    harness.reference->setOperatorEnvelopeLevels(1, 1.0f, 0.5f, 0.25f, 0.0f);
+    harness.kernel->postOperatorEnvelopeRates(2, 99.0f, 60.0f, 40.0f, 30.0f);
+    harness.reference->setOperatorEnvelopeRates(2, 99.0f, 60.0f, 40.0f, 30.0f);
+
+    // A single stage keeps the other three, and the last value posted wins
+    harness.kernel->postParameter(DX7::getOperatorEGRateAddress(3, 1), 10.0f);
+    harness.kernel->postParameter(DX7::getOperatorEGRateAddress(3, 1), 20.0f);
+    harness.reference->setOperatorEnvelopeRates(3, 99.0f, 20.0f, 99.0f, 99.0f);
+    expect(harness.kernel->postParameter(DX7::getOperatorEGLevelAddress(4, 2), 0.5f),
+           "EG level addresses can be posted");
+    harness.reference->setOperatorEnvelopeLevels(4, 1.0f, 1.0f, 0.5f, 0.0f);
+    expect(!harness.kernel->postParameter(DX7::kGlobalFeedbackAddress, 0.5f), "reserved address is not posted");
+
+    harness.kernel->noteOn(64, 100);
+    harness.reference->noteOn(64, 100);
+    bool allMatch = true;
+    for (int block = 0; block < 16; ++block) {
+        harness.render();
+        allMatch &= harness.matches(0, kBlockFrames, 1.0f);
+    }
+    expect(allMatch, "posted feedback and EG values apply at the next render");
+}
+
+void testNonRampableAddresses() {
+    M2DXKernel kernel;
+    kernel.initialize(48000.0f);
+    int feedback = DX7::getOperatorParameterAddress(0, DX7::kOperatorFeedbackOffset);
+    expect(!kernel.scheduleParameterRamp(feedback, 0.5f, 0, 10), "feedback is not rampable");
+    expect(kernel.setParameter(feedback, 0.5f), "feedback falls back to the immediate setter");
+    expect(kernel.setParameter(DX7::getOperatorParameterAddress(5, DX7::kOperatorEGLevelOffset + 3), 0.0f),
+           "EG level addresses are settable");
+    expect(!kernel.setParameter(DX7::kGlobalFeedbackAddress, 0.5f), "reserved address is rejected");
+}
+
+} // namespace
+
+int main() {
+    testRampCurves();
+    testStepAtFrameOffset();
+    testLinearEndpoint();
+    testCarryOver();
+    testSetterCancelsRamp();
+    testPostedNonRampableParameters();
+    testNonRampableAddresses();
+    return Test::finish("parameter ramp");
+}
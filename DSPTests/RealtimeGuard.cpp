@@ -0,0 +1,233 @@
+#include "RealtimeGuard.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cerrno>
+#include <cstring>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <time.h>
+#include <unistd.h>
+
+// glibc allocator entry points; the interposed malloc family forwards here
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* pointer, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+void __libc_free(void* pointer);
+}
+
+namespace M2DX::RealtimeGuard {
+namespace {
+
+thread_local int realtimeDepth = 0;
+thread_local bool reporting = false;
+
+std::atomic<uint64_t> violations{0};
+std::atomic<bool> quiet{false};
+
+template <typename Function>
+Function resolve(const char* name, const char* version = nullptr) {
+    void* symbol = version ? dlvsym(RTLD_NEXT, name, version) : nullptr;
+    if (!symbol) symbol = dlsym(RTLD_NEXT, name);
+    return reinterpret_cast<Function>(symbol);
+}
+
+// Real implementations, resolved lazily (and eagerly by install())
+using MutexFn = int (*)(pthread_mutex_t*);
+using CondWaitFn = int (*)(pthread_cond_t*, pthread_mutex_t*);
+using CondTimedWaitFn = int (*)(pthread_cond_t*, pthread_mutex_t*, const struct timespec*);
+using RWLockFn = int (*)(pthread_rwlock_t*);
+using SemWaitFn = int (*)(sem_t*);
+using NanosleepFn = int (*)(const struct timespec*, struct timespec*);
+using UsleepFn = int (*)(useconds_t);
+using WriteFn = ssize_t (*)(int, const void*, size_t);
+using ReadFn = ssize_t (*)(int, void*, size_t);
+
+MutexFn realMutexLock = nullptr;
+MutexFn realMutexTrylock = nullptr;
+CondWaitFn realCondWait = nullptr;
+CondTimedWaitFn realCondTimedWait = nullptr;
+RWLockFn realRWLockRdlock = nullptr;
+RWLockFn realRWLockWrlock = nullptr;
+SemWaitFn realSemWait = nullptr;
+NanosleepFn realNanosleep = nullptr;
+UsleepFn realUsleep = nullptr;
+WriteFn realWrite = nullptr;
+ReadFn realRead = nullptr;
+
+void resolveAll() {
+    realMutexLock = resolve<MutexFn>("pthread_mutex_lock");
+    realMutexTrylock = resolve<MutexFn>("pthread_mutex_trylock");
+    // Unversioned lookup returns the pre-2.3.2 condvar ABI on x86_64
+    realCondWait = resolve<CondWaitFn>("pthread_cond_wait", "GLIBC_2.3.2");
+    realCondTimedWait = resolve<CondTimedWaitFn>("pthread_cond_timedwait", "GLIBC_2.3.2");
+    realRWLockRdlock = resolve<RWLockFn>("pthread_rwlock_rdlock");
+    realRWLockWrlock = resolve<RWLockFn>("pthread_rwlock_wrlock");
+    realSemWait = resolve<SemWaitFn>("sem_wait");
+    realNanosleep = resolve<NanosleepFn>("nanosleep");
+    realUsleep = resolve<UsleepFn>("usleep");
+    realWrite = resolve<WriteFn>("write");
+    realRead = resolve<ReadFn>("read");
+}
+
+template <typename Function>
+Function real(Function& slot, const char* name) {
+    if (!slot) slot = resolve<Function>(name);
+    return slot;
+}
+
+/// Report a violation if the calling thread is inside a RealtimeScope
+/// Only async-signal-safe, non-allocating calls are made while reporting.
+void check(const char* primitive) {
+    if (realtimeDepth == 0 || reporting) return;
+
+    reporting = true;
+    violations.fetch_add(1, std::memory_order_relaxed);
+
+    if (!quiet.load(std::memory_order_relaxed)) {
+        static const char kPrefix[] = "\n[RealtimeGuard] violation: ";
+        static const char kSuffix[] = " called on the render path\n";
+        realWrite(STDERR_FILENO, kPrefix, sizeof(kPrefix) - 1);
+        realWrite(STDERR_FILENO, primitive, std::strlen(primitive));
+        realWrite(STDERR_FILENO, kSuffix, sizeof(kSuffix) - 1);
+
+        void* frames[64];
+        int depth = backtrace(frames, 64);
+        backtrace_symbols_fd(frames, depth, STDERR_FILENO);
+    }
+    reporting = false;
+}
+
+} // namespace
+
+RealtimeScope::RealtimeScope() { ++realtimeDepth; }
+RealtimeScope::~RealtimeScope() { --realtimeDepth; }
+
+void install() {
+    resolveAll();
+
+    // backtrace() loads libgcc and allocates on first use; do it up front
+    void* frames[4];
+    backtrace(frames, 4);
+}
+
+uint64_t violationCount() { return violations.load(); }
+void resetViolationCount() { violations.store(0); }
+void setQuiet(bool value) { quiet.store(value); }
+
+} // namespace M2DX::RealtimeGuard
+
+// ============================================================================
+// MARK: - Interposed primitives
+// ============================================================================
+
+using M2DX::RealtimeGuard::check;
+using namespace M2DX::RealtimeGuard;
+
+extern "C" {
+
+// Allocation (operator new/delete reach these through libstdc++)
+
+void* malloc(size_t size) noexcept {
+    check("malloc");
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) noexcept {
+    check("calloc");
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* pointer, size_t size) noexcept {
+    check("realloc");
+    return __libc_realloc(pointer, size);
+}
+
+void free(void* pointer) noexcept {
+    if (pointer) check("free");
+    __libc_free(pointer);
+}
+
+void* memalign(size_t alignment, size_t size) noexcept {
+    check("memalign");
+    return __libc_memalign(alignment, size);
+}
+
+void* aligned_alloc(size_t alignment, size_t size) noexcept {
+    check("aligned_alloc");
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** pointer, size_t alignment, size_t size) noexcept {
+    check("posix_memalign");
+    void* result = __libc_memalign(alignment, size);
+    if (!result) return ENOMEM;
+    *pointer = result;
+    return 0;
+}
+
+// Locks
+
+int pthread_mutex_lock(pthread_mutex_t* mutex) noexcept {
+    check("pthread_mutex_lock");
+    return real(realMutexLock, "pthread_mutex_lock")(mutex);
+}
+
+int pthread_mutex_trylock(pthread_mutex_t* mutex) noexcept {
+    check("pthread_mutex_trylock");
+    return real(realMutexTrylock, "pthread_mutex_trylock")(mutex);
+}
+
+int pthread_cond_wait(pthread_cond_t* condition, pthread_mutex_t* mutex) {
+    check("pthread_cond_wait");
+    return real(realCondWait, "pthread_cond_wait")(condition, mutex);
+}
+
+int pthread_cond_timedwait(pthread_cond_t* condition, pthread_mutex_t* mutex,
+                           const struct timespec* deadline) {
+    check("pthread_cond_timedwait");
+    return real(realCondTimedWait, "pthread_cond_timedwait")(condition, mutex, deadline);
+}
+
+int pthread_rwlock_rdlock(pthread_rwlock_t* lock) noexcept {
+    check("pthread_rwlock_rdlock");
+    return real(realRWLockRdlock, "pthread_rwlock_rdlock")(lock);
+}
+
+int pthread_rwlock_wrlock(pthread_rwlock_t* lock) noexcept {
+    check("pthread_rwlock_wrlock");
+    return real(realRWLockWrlock, "pthread_rwlock_wrlock")(lock);
+}
+
+int sem_wait(sem_t* semaphore) {
+    check("sem_wait");
+    return real(realSemWait, "sem_wait")(semaphore);
+}
+
+// Blocking syscalls
+
+int nanosleep(const struct timespec* duration, struct timespec* remaining) {
+    check("nanosleep");
+    return real(realNanosleep, "nanosleep")(duration, remaining);
+}
+
+int usleep(useconds_t microseconds) {
+    check("usleep");
+    return real(realUsleep, "usleep")(microseconds);
+}
+
+ssize_t write(int fd, const void* buffer, size_t count) {
+    check("write");
+    return real(realWrite, "write")(fd, buffer, count);
+}
+
+ssize_t read(int fd, void* buffer, size_t count) {
+    check("read");
+    return real(realRead, "read")(fd, buffer, count);
+}
+
+} // extern "C"
@@ -0,0 +1,38 @@
+#ifndef RealtimeGuard_hpp
+#define RealtimeGuard_hpp
+
+#include <cstdint>
+
+/// Real-time safety instrumentation for DSP tests (Linux)
+///
+/// RealtimeGuard.cpp interposes allocation, lock and blocking syscall
+/// primitives for the whole test process. A call made on a thread that is
+/// inside a RealtimeScope is reported as a violation with a stack trace.
+/// Calls outside a scope are forwarded untouched.
+namespace M2DX::RealtimeGuard {
+
+/// Marks the current thread as executing real-time code for its lifetime
+class RealtimeScope {
+public:
+    RealtimeScope();
+    ~RealtimeScope();
+
+    RealtimeScope(const RealtimeScope&) = delete;
+    RealtimeScope& operator=(const RealtimeScope&) = delete;
+};
+
+/// Resolve interposed symbols and warm up the backtrace machinery
+/// Must be called once before the first RealtimeScope.
+void install();
+
+/// Total violations reported since the last reset
+uint64_t violationCount();
+
+void resetViolationCount();
+
+/// Suppress stack trace output (used by the checker self-test)
+void setQuiet(bool quiet);
+
+} // namespace M2DX::RealtimeGuard
+
+#endif /* RealtimeGuard_hpp */
@@ -0,0 +1,316 @@
+// RealtimeSafetyTests.cpp
+// Runs M2DXKernel through a matrix of event scripts with RealtimeGuard active
+// and fails on any allocation, lock or blocking syscall on the render path.
+
+#include "RealtimeGuard.hpp"
+#include "M2DXKernel.hpp"
+#include "CaptureWriter.hpp"
+#include "TraceWriter.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace M2DX;
+using RealtimeGuard::RealtimeScope;
+
+namespace {
+
+// MARK: - Event Scripts
+
+enum class EventType {
+    NoteOn,
+    NoteOff,
+    AllNotesOff,
+    ParameterRamp,
+    SetOperatorLevel,
+    SetOperatorRatio,
+    SetAlgorithm,
+    SetMasterVolume,
+    SetEnvelopeRates,
+    SetVelocitySensitivity,
+    PostParameter,  // Drained by the next processBuffer()
+    SetParameter,   // Render-list fallback for non-rampable addresses
+    SampleRateChange
+};
+
+struct ScriptEvent {
+    int frame;
+    EventType type;
+    int a = 0;
+    float b = 0.0f;
+    int c = 0;
+};
+
+struct Script {
+    std::string name;
+    int lengthFrames;
+    std::vector<ScriptEvent> events;  // Sorted by frame
+};
+
+Script makeNoteBurst() {
+    Script script{"note-burst", 24000, {}};
+    for (int i = 0; i < 12; ++i) {
+        script.events.push_back({0, EventType::NoteOn, 48 + i * 3, 0.0f, 100});
+    }
+    for (int i = 0; i < 12; ++i) {
+        script.events.push_back({12000, EventType::NoteOff, 48 + i * 3});
+    }
+    script.events.push_back({20000, EventType::AllNotesOff});
+    return script;
+}
+
+Script makeVoiceStealing() {
+    Script script{"voice-stealing", 24000, {}};
+    for (int i = 0; i < 64; ++i) {
+        script.events.push_back({i * 200, EventType::NoteOn, 36 + (i * 7) % 60, 0.0f, 1 + (i * 13) % 127});
+    }
+    return script;
+}
+
+Script makeParameterChanges() {
+    Script script{"parameter-changes", 24000, {}};
+    script.events.push_back({0, EventType::NoteOn, 60, 0.0f, 110});
+    script.events.push_back({0, EventType::NoteOn, 64, 0.0f, 90});
+    for (int i = 0; i < 40; ++i) {
+        int frame = i * 500;
+        int op = i % kNumOperators;
+        script.events.push_back({frame, EventType::ParameterRamp,
+                                 DX7::getOperatorLevelAddress(op), 0.2f + 0.02f * i, 480});
+        script.events.push_back({frame + 7, EventType::ParameterRamp,
+                                 DX7::getOperatorDetuneAddress(op), -20.0f + i, 300});
+        script.events.push_back({frame + 11, EventType::ParameterRamp,
+                                 DX7::kMasterVolumeAddress, (i % 2) ? 0.4f : 0.8f, 1000});
+        if (i % 5 == 0) {
+            script.events.push_back({frame + 13, EventType::SetOperatorRatio, op, 0.5f + i * 0.1f});
+            script.events.push_back({frame + 17, EventType::SetAlgorithm, i % kNumAlgorithms});
+            script.events.push_back({frame + 19, EventType::SetEnvelopeRates, op, 40.0f + i});
+            script.events.push_back({frame + 23, EventType::SetVelocitySensitivity, op, 0.0f, i % 8});
+        }
+        if (i % 7 == 0) {
+            script.events.push_back({frame + 29, EventType::SetOperatorLevel, op, 0.9f});
+            script.events.push_back({frame + 31, EventType::SetMasterVolume, 0, 0.7f});
+        }
+        if (i % 3 == 0) {
+            int stage = i % DX7::kEnvelopeStages;
+            script.events.push_back({frame + 37, EventType::PostParameter,
+                                     DX7::getOperatorFeedbackAddress(op), 0.1f * (i % 8)});
+            script.events.push_back({frame + 41, EventType::PostParameter,
+                                     DX7::getOperatorEGRateAddress(op, stage), 30.0f + i});
+            script.events.push_back({frame + 43, EventType::PostParameter,
+                                     DX7::getOperatorEGLevelAddress(op, stage), 0.5f});
+            script.events.push_back({frame + 47, EventType::PostParameter,
+                                     DX7::getOperatorRatioAddress(op), 1.0f + 0.25f * i});
+            script.events.push_back({frame + 53, EventType::SetParameter,
+                                     DX7::getOperatorEGRateAddress(op, 3 - stage), 50.0f + i});
+            script.events.push_back({frame + 59, EventType::SetParameter,
+                                     DX7::getOperatorEGLevelAddress(op, 3 - stage), 0.7f});
+            script.events.push_back({frame + 61, EventType::SetParameter,
+                                     DX7::getOperatorFeedbackAddress(op), 0.2f});
+            script.events.push_back({frame + 67, EventType::SetParameter, DX7::kAlgorithmAddress,
+                                     static_cast<float>((i + 3) % kNumAlgorithms)});
+        }
+    }
+    return script;
+}
+
+Script makeSampleRateChanges() {
+    Script script{"sample-rate-changes", 24000, {}};
+    const float rates[] = {44100.0f, 48000.0f, 88200.0f, 96000.0f};
+    for (int i = 0; i < 8; ++i) {
+        int frame = i * 3000;
+        script.events.push_back({frame, EventType::NoteOn, 50 + i, 0.0f, 100});
+        script.events.push_back({frame + 64, EventType::ParameterRamp,
+                                 DX7::getOperatorRatioAddress(i % kNumOperators), 1.0f + i, 2000});
+        script.events.push_back({frame + 1500, EventType::SampleRateChange, 0, rates[i % 4]});
+    }
+    return script;
+}
+
+void applyEvent(M2DXKernel& kernel, const ScriptEvent& event, int frameOffset) {
+    switch (event.type) {
+        case EventType::NoteOn:
+            kernel.noteOn(static_cast<uint8_t>(event.a), static_cast<uint8_t>(event.c));
+            break;
+        case EventType::NoteOff:
+            kernel.noteOff(static_cast<uint8_t>(event.a));
+            break;
+        case EventType::AllNotesOff:
+            kernel.allNotesOff();
+            break;
+        case EventType::ParameterRamp:
+            kernel.scheduleParameterRamp(event.a, event.b, frameOffset, event.c);
+            break;
+        case EventType::SetOperatorLevel:
+            kernel.setOperatorLevel(event.a, event.b);
+            break;
+        case EventType::SetOperatorRatio:
+            kernel.setOperatorRatio(event.a, event.b);
+            break;
+        case EventType::SetAlgorithm:
+            kernel.setAlgorithm(event.a);
+            break;
+        case EventType::SetMasterVolume:
+            kernel.setMasterVolume(event.b);
+            break;
+        case EventType::SetEnvelopeRates:
+            kernel.setOperatorEnvelopeRates(event.a, event.b, 60.0f, 45.0f, 30.0f);
+            break;
+        case EventType::SetVelocitySensitivity:
+            kernel.setOperatorVelocitySensitivity(event.a, event.c);
+            break;
+        case EventType::PostParameter:
+            kernel.postParameter(event.a, event.b);
+            break;
+        case EventType::SetParameter:
+            kernel.setParameter(event.a, event.b);
+            break;
+        case EventType::SampleRateChange:
+            kernel.initialize(event.b);
+            break;
+    }
+}
+
+// MARK: - Runner
+
+struct RunConfig {
+    int blockSize;
+    float sampleRate;
+    bool capture;  // Attach the capture tap and the event trace recorder
+};
+
+struct RunResult {
+    uint64_t violations = 0;
+    bool tapsStarted = true;  // Capture and trace writers started when requested
+};
+
+/// Render a script block by block; events and processBuffer run inside a RealtimeScope
+/// the same way the AU render block handles them
+RunResult runScript(const Script& script, const RunConfig& config, const std::string& captureDirectory) {
+    RunResult result;
+
+    auto kernel = std::make_unique<M2DXKernel>();
+    kernel->initialize(config.sampleRate);
+
+    std::vector<float> left(config.blockSize);
+    std::vector<float> right(config.blockSize);
+
+    std::unique_ptr<CaptureRing> ring;
+    std::unique_ptr<CaptureWriter> writer;
+    if (config.capture) {
+        // Small ring so overruns are exercised as well
+        ring = std::make_unique<CaptureRing>(8192);
+        writer = std::make_unique<CaptureWriter>(*ring);
+        result.tapsStarted &= writer->start(captureDirectory, script.name, config.sampleRate, {1 << 20, 0.0});
+        kernel->setCaptureRing(ring.get());
+    }
+
+    std::unique_ptr<TraceRecorder> recorder;
+    std::unique_ptr<TraceWriter> traceWriter;
+    if (config.capture) {
+        // Small ring so dropped events are exercised as well
+        recorder = std::make_unique<TraceRecorder>(256);
+        traceWriter = std::make_unique<TraceWriter>(*recorder);
+        result.tapsStarted &= traceWriter->start(captureDirectory + "/" + script.name + ".m2dxtrace");
+        kernel->setTraceRecorder(recorder.get());
+    }
+
+    RealtimeGuard::resetViolationCount();
+    size_t nextEvent = 0;
+    for (int blockStart = 0; blockStart < script.lengthFrames; blockStart += config.blockSize) {
+        int frames = std::min(config.blockSize, script.lengthFrames - blockStart);
+        int blockEnd = blockStart + frames;
+
+        RealtimeScope scope;
+        while (nextEvent < script.events.size() && script.events[nextEvent].frame < blockEnd) {
+            const ScriptEvent& event = script.events[nextEvent++];
+            applyEvent(*kernel, event, event.frame - blockStart);
+        }
+        kernel->processBuffer(left.data(), right.data(), frames);
+    }
+    result.violations = RealtimeGuard::violationCount();
+
+    if (writer) {
+        kernel->setCaptureRing(nullptr);
+        writer->stop();
+    }
+    if (traceWriter) {
+        kernel->setTraceRecorder(nullptr);
+        traceWriter->stop();
+    }
+    return result;
+}
+
+/// The checker must itself detect a violation, or a passing run means nothing
+bool selfTest() {
+    static void* volatile sink = nullptr;
+
+    RealtimeGuard::setQuiet(true);
+    RealtimeGuard::resetViolationCount();
+    {
+        RealtimeScope scope;
+        sink = std::malloc(64);
+    }
+    std::free(sink);
+    uint64_t detected = RealtimeGuard::violationCount();
+    RealtimeGuard::setQuiet(false);
+    return detected > 0;
+}
+
+} // namespace
+
+int main() {
+    RealtimeGuard::install();
+
+    if (!selfTest()) {
+        std::fprintf(stderr, "FAIL: RealtimeGuard did not detect a deliberate allocation\n");
+        return EXIT_FAILURE;
+    }
+
+    char directoryTemplate[] = "/tmp/m2dx-rt-XXXXXX";
+    const char* captureDirectory = mkdtemp(directoryTemplate);
+    if (!captureDirectory) {
+        std::fprintf(stderr, "FAIL: cannot create capture directory\n");
+        return EXIT_FAILURE;
+    }
+
+    const std::vector<Script> scripts = {
+        makeNoteBurst(), makeVoiceStealing(), makeParameterChanges(), makeSampleRateChanges()
+    };
+    const int blockSizes[] = {1, 17, 64, 512, 4096};
+    const float sampleRates[] = {44100.0f, 48000.0f, 96000.0f};
+
+    int failures = 0;
+    int runs = 0;
+    for (const auto& script : scripts) {
+        for (int blockSize : blockSizes) {
+            for (float sampleRate : sampleRates) {
+                for (bool capture : {false, true}) {
+                    RunConfig config{blockSize, sampleRate, capture};
+                    RunResult result = runScript(script, config, captureDirectory);
+                    ++runs;
+                    if (result.violations > 0 || !result.tapsStarted) {
+                        ++failures;
+                    }
+                    if (result.violations > 0) {
+                        std::fprintf(stderr, "FAIL: %s block=%d rate=%.0f taps=%d: %llu violation(s)\n",
+                                     script.name.c_str(), blockSize, sampleRate, capture,
+                                     static_cast<unsigned long long>(result.violations));
+                    }
+                    if (!result.tapsStarted) {
+                        std::fprintf(stderr, "FAIL: %s block=%d rate=%.0f: capture or trace writer did not start\n",
+                                     script.name.c_str(), blockSize, sampleRate);
+                    }
+                }
+            }
+        }
+    }
+
+    std::filesystem::remove_all(captureDirectory);
+
+    std::printf("%d/%d real-time safety runs passed\n", runs - failures, runs);
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,36 @@
+#ifndef TestSupport_hpp
+#define TestSupport_hpp
+
+#include <cstdio>
+#include <cstdlib>
+
+/// Minimal check helpers shared by the DSP test executables
+namespace M2DX::Test {
+
+inline int& failureCount() {
+    static int failures = 0;
+    return failures;
+}
+
+/// Record a failed check without stopping the test
+inline bool expect(bool condition, const char* message) {
+    if (!condition) {
+        ++failureCount();
+        std::fprintf(stderr, "FAIL: %s\n", message);
+    }
+    return condition;
+}
+
+/// Print a summary and return the process exit status
+inline int finish(const char* suite) {
+    if (failureCount() > 0) {
+        std::fprintf(stderr, "%d %s check(s) failed\n", failureCount(), suite);
+        return EXIT_FAILURE;
+    }
+    std::printf("%s checks passed\n", suite);
+    return EXIT_SUCCESS;
+}
+
+} // namespace M2DX::Test
+
+#endif /* TestSupport_hpp */
@@ -0,0 +1,174 @@
+#ifndef TraceReplay_hpp
+#define TraceReplay_hpp
+
+#include "EventTrace.hpp"
+#include "M2DXKernel.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace M2DX {
+
+/// FNV-1a hash over the bit patterns of rendered samples
+/// Any difference in output, including -0.0 vs 0.0 or NaN payloads, changes the value.
+class OutputChecksum {
+public:
+    void add(const float* samples, int count) {
+        for (int i = 0; i < count; ++i) {
+            uint32_t bits;
+            std::memcpy(&bits, &samples[i], sizeof(bits));
+            for (int b = 0; b < 4; ++b) {
+                hash_ ^= (bits >> (8 * b)) & 0xFF;
+                hash_ *= 0x100000001B3ull;
+            }
+        }
+    }
+
+    uint64_t value() const { return hash_; }
+
+private:
+    uint64_t hash_ = 0xCBF29CE484222325ull;
+};
+
+/// Apply one recorded kernel call (everything except Block and Dropped)
+inline void applyTraceEvent(M2DXKernel& kernel, const TraceEvent& event) {
+    const auto& i = event.ints;
+    const auto& v = event.values;
+    switch (event.type) {
+        case TraceEventType::SampleRate:
+            kernel.initialize(v[0]);
+            break;
+        case TraceEventType::NoteOn:
+            kernel.noteOn(static_cast<uint8_t>(i[0]), static_cast<uint8_t>(i[1]));
+            break;
+        case TraceEventType::NoteOff:
+            kernel.noteOff(static_cast<uint8_t>(i[0]));
+            break;
+        case TraceEventType::AllNotesOff:
+            kernel.allNotesOff();
+            break;
+        case TraceEventType::Algorithm:
+            kernel.setAlgorithm(i[0]);
+            break;
+        case TraceEventType::MasterVolume:
+            kernel.setMasterVolume(v[0]);
+            break;
+        case TraceEventType::OperatorLevel:
+            kernel.setOperatorLevel(i[0], v[0]);
+            break;
+        case TraceEventType::OperatorRatio:
+            kernel.setOperatorRatio(i[0], v[0]);
+            break;
+        case TraceEventType::OperatorDetune:
+            kernel.setOperatorDetune(i[0], v[0]);
+            break;
+        case TraceEventType::OperatorFeedback:
+            kernel.setOperatorFeedback(i[0], v[0]);
+            break;
+        case TraceEventType::OperatorEnvelopeRates:
+            kernel.setOperatorEnvelopeRates(i[0], v[0], v[1], v[2], v[3]);
+            break;
+        case TraceEventType::OperatorEnvelopeLevels:
+            kernel.setOperatorEnvelopeLevels(i[0], v[0], v[1], v[2], v[3]);
+            break;
+        case TraceEventType::OperatorKeyboardLevelScaling:
+            kernel.setOperatorKeyboardLevelScaling(i[0], i[1], i[2], i[3], i[4], i[5]);
+            break;
+        case TraceEventType::OperatorRateScaling:
+            kernel.setOperatorRateScaling(i[0], i[1]);
+            break;
+        case TraceEventType::OperatorVelocitySensitivity:
+            kernel.setOperatorVelocitySensitivity(i[0], i[1]);
+            break;
+        case TraceEventType::ParameterRamp:
+            kernel.scheduleParameterRamp(i[0], v[0], i[1], i[2], static_cast<RampShape>(i[3]));
+            break;
+        case TraceEventType::RampState: {
+            ParameterRampState state{v[0], v[1], v[2], v[3], i[1], i[2] != 0};
+            kernel.restoreParameterRamp(i[0], state);
+            break;
+        }
+        case TraceEventType::Block:
+        case TraceEventType::Dropped:
+        case TraceEventType::Count:
+            break;
+    }
+}
+
+/// Per-block measurement passed to a replay observer
+struct ReplayBlock {
+    uint64_t frame;         // Trace frame position at the start of the block
+    int numFrames;
+    float sampleRate;
+    double seconds;         // Wall time spent in processBuffer()
+    const float* left;
+    const float* right;
+};
+
+/// Totals for one replay pass
+struct ReplayResult {
+    uint64_t events = 0;
+    uint64_t blocks = 0;
+    uint64_t frames = 0;
+    uint64_t droppedEvents = 0;  // Events the recorder reported as lost
+    uint64_t checksum = 0;
+    bool truncated = false;
+};
+
+/// Re-render a trace on a fresh kernel
+/// Events are applied in recorded order and every Block event renders one
+/// processBuffer() call of the recorded size, so the output is bit-identical
+/// to the original render when the trace is complete.
+/// @param observer Called as observer(const ReplayBlock&) after each block
+template <typename Observer>
+ReplayResult replayTrace(TraceReader& reader, Observer&& observer) {
+    reader.rewind();
+
+    auto kernel = std::make_unique<M2DXKernel>();
+    std::vector<float> left;
+    std::vector<float> right;
+    float sampleRate = 44100.0f;
+    OutputChecksum checksum;
+    ReplayResult result;
+
+    TraceEvent event;
+    while (reader.next(event)) {
+        ++result.events;
+        if (event.type == TraceEventType::SampleRate) {
+            sampleRate = event.values[0];
+        }
+
+        if (event.type == TraceEventType::Dropped) {
+            result.droppedEvents += static_cast<uint64_t>(event.ints[0]);
+        } else if (event.type != TraceEventType::Block) {
+            applyTraceEvent(*kernel, event);
+        } else {
+            int numFrames = std::max(event.ints[0], 0);
+            if (static_cast<size_t>(numFrames) > left.size()) {
+                left.resize(numFrames);
+                right.resize(numFrames);
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            kernel->processBuffer(left.data(), right.data(), numFrames);
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+            checksum.add(left.data(), numFrames);
+            checksum.add(right.data(), numFrames);
+            ++result.blocks;
+            result.frames += static_cast<uint64_t>(numFrames);
+            observer(ReplayBlock{event.frame, numFrames, sampleRate, elapsed.count(),
+                                 left.data(), right.data()});
+        }
+    }
+
+    result.checksum = checksum.value();
+    result.truncated = reader.isTruncated();
+    return result;
+}
+
+} // namespace M2DX
+
+#endif /* TraceReplay_hpp */
@@ -0,0 +1,357 @@
+// TraceReplayTests.cpp
+// Records a session with the event trace recorder and checks that an offline
+// replay reproduces the original output bit for bit.
+
+#include "TestSupport.hpp"
+#include "TraceReplay.hpp"
+#include "TraceWriter.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace M2DX;
+using Test::expect;
+
+namespace {
+
+bool writeFile(const std::string& path, const std::vector<uint8_t>& data) {
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) return false;
+    bool ok = std::fwrite(data.data(), 1, data.size(), file) == data.size();
+    std::fclose(file);
+    return ok;
+}
+
+// MARK: - Encoding
+
+void testEncodingRoundTrip(const std::string& directory) {
+    std::vector<TraceEvent> events;
+    TraceEvent noteOn;
+    noteOn.frame = 0;
+    noteOn.type = TraceEventType::NoteOn;
+    noteOn.ints = {60, 127};
+    events.push_back(noteOn);
+
+    TraceEvent ramp;
+    ramp.frame = 1u << 20;
+    ramp.type = TraceEventType::ParameterRamp;
+    ramp.ints = {DX7::getOperatorDetuneAddress(3), 511, 48000, static_cast<int32_t>(RampShape::Exponential)};
+    ramp.values = {-37.5f};
+    events.push_back(ramp);
+
+    TraceEvent scaling;
+    scaling.frame = 5;  // Earlier than the previous event: negative delta
+    scaling.type = TraceEventType::OperatorKeyboardLevelScaling;
+    scaling.ints = {5, 99, 0, 99, 3, 2};
+    events.push_back(scaling);
+
+    TraceEvent rates;
+    rates.frame = 5;
+    rates.type = TraceEventType::OperatorEnvelopeRates;
+    rates.ints = {2};
+    rates.values = {99.0f, 0.25f, -0.0f, 1e-30f};
+    events.push_back(rates);
+
+    std::vector<uint8_t> data;
+    TraceEncoder encoder;
+    TraceEncoder::appendHeader(data);
+    for (const auto& event : events) encoder.append(event, data);
+    expect(data.size() < kTraceHeaderBytes + events.size() * 20, "encoding is compact");
+
+    std::string path = directory + "/roundtrip.m2dxtrace";
+    expect(writeFile(path, data), "write roundtrip trace");
+
+    TraceReader reader;
+    expect(reader.open(path), "open roundtrip trace");
+    TraceEvent decoded;
+    for (const auto& event : events) {
+        bool ok = reader.next(decoded);
+        expect(ok, "decode event");
+        if (!ok) return;
+        expect(decoded.type == event.type, "type round trip");
+        expect(decoded.frame == event.frame, "frame round trip");
+        expect(decoded.ints == event.ints, "ints round trip");
+        expect(std::memcmp(decoded.values.data(), event.values.data(), sizeof(event.values)) == 0,
+               "values round trip (bit exact)");
+    }
+    expect(!reader.next(decoded), "end of trace");
+    expect(!reader.isTruncated(), "complete trace is not truncated");
+
+    // A writer killed mid-record leaves a partial tail
+    data.pop_back();
+    expect(writeFile(path, data), "write truncated trace");
+    expect(reader.open(path), "open truncated trace");
+    int count = 0;
+    while (reader.next(decoded)) ++count;
+    expect(count == static_cast<int>(events.size()) - 1, "events before the partial record are kept");
+    expect(reader.isTruncated(), "partial record is reported");
+
+    data.assign({'N', 'O', 'T', 'A', 'T', 'R', 'C', kTraceVersion});
+    expect(writeFile(path, data), "write bad header");
+    expect(!reader.open(path), "bad magic is rejected");
+}
+
+// MARK: - Recorder
+
+void testRecorderDropsWhenFull() {
+    TraceRecorder recorder(4);
+    TraceEvent event;
+    event.type = TraceEventType::NoteOff;
+
+    int recorded = 0;
+    for (int i = 0; i < 10; ++i) {
+        event.frame = static_cast<uint64_t>(i);
+        event.ints[0] = i;
+        if (recorder.record(event)) ++recorded;
+    }
+    expect(recorded == 4, "full ring rejects events");
+    expect(recorder.getDroppedEvents() == 6, "dropped events are counted");
+
+    TraceEvent popped;
+    while (recorder.pop(popped)) {}
+
+    event.ints[0] = 42;
+    expect(recorder.record(event), "record after drain");
+    expect(recorder.pop(popped) && popped.type == TraceEventType::Dropped && popped.ints[0] == 6,
+           "gap is reported in-stream before the next event");
+    expect(recorder.pop(popped) && popped.type == TraceEventType::NoteOff && popped.ints[0] == 42,
+           "event follows the gap marker");
+}
+
+// MARK: - Replay
+
+/// Render a session with irregular block sizes, ramps, voice stealing and a
+/// sample rate change while recording
+uint64_t recordSession(const std::string& path, uint64_t& eventsWritten) {
+    auto kernel = std::make_unique<M2DXKernel>();
+    kernel->initialize(48000.0f);
+
+    // Patch set before recording starts reaches the trace through the snapshot
+    kernel->setAlgorithm(4);
+    for (int op = 0; op < kNumOperators; ++op) {
+        kernel->setOperatorLevel(op, 0.9f - 0.1f * op);
+        kernel->setOperatorRatio(op, 1.0f + 0.5f * op);
+        kernel->setOperatorDetune(op, static_cast<float>(op) - 2.5f);
+        kernel->setOperatorFeedback(op, op == 5 ? 0.4f : 0.0f);
+        kernel->setOperatorEnvelopeRates(op, 90.0f, 60.0f - op, 40.0f, 55.0f);
+        kernel->setOperatorEnvelopeLevels(op, 1.0f, 0.7f, 0.5f, 0.0f);
+        kernel->setOperatorKeyboardLevelScaling(op, 39 + op, 20 * op % 99, 50, op % 4, 3 - op % 4);
+        kernel->setOperatorRateScaling(op, op);
+        kernel->setOperatorVelocitySensitivity(op, 7 - op);
+    }
+    kernel->setMasterVolume(0.6f);
+
+    TraceRecorder recorder(1 << 14);
+    TraceWriter writer(recorder);
+    if (!expect(writer.start(path), "trace writer starts")) return 0;
+
+    // The recorder attaches at the end of the next render call
+    std::vector<float> left(512);
+    std::vector<float> right(512);
+    kernel->setTraceRecorder(&recorder);
+    kernel->processBuffer(left.data(), right.data(), 64);
+
+    const int blockSizes[] = {128, 17, 512, 1, 64, 333};
+    OutputChecksum checksum;
+
+    for (int block = 0; block < 400; ++block) {
+        int frames = blockSizes[block % 6];
+        if (block % 9 == 0) {
+            kernel->noteOn(static_cast<uint8_t>(36 + (block * 5) % 60), static_cast<uint8_t>(1 + block % 127));
+        }
+        if (block % 13 == 0) {
+            kernel->noteOff(static_cast<uint8_t>(36 + (block * 3) % 60));
+        }
+        if (block % 11 == 0) {
+            int op = block % kNumOperators;
+            kernel->scheduleParameterRamp(DX7::getOperatorLevelAddress(op), 0.3f + 0.001f * block,
+                                          frames / 2, 700, RampShape::Exponential);
+            kernel->scheduleParameterRamp(DX7::kMasterVolumeAddress, (block % 2) ? 0.5f : 0.8f, 0, 300);
+        }
+        if (block == 150) kernel->setAlgorithm(31);
+        if (block == 200) kernel->initialize(44100.0f);
+        if (block == 250) kernel->setOperatorLevel(2, 0.0f);
+        if (block == 390) kernel->allNotesOff();
+
+        kernel->processBuffer(left.data(), right.data(), frames);
+        checksum.add(left.data(), frames);
+        checksum.add(right.data(), frames);
+    }
+
+    kernel->setTraceRecorder(nullptr);
+    writer.stop();
+    expect(!writer.hasWriteError(), "trace writer reports no error");
+    expect(recorder.getDroppedEvents() == 0, "recorder drops nothing in the session");
+    eventsWritten = writer.getEventsWritten();
+    return checksum.value();
+}
+
+void testReplayIsBitExact(const std::string& directory) {
+    std::string path = directory + "/session.m2dxtrace";
+    uint64_t eventsWritten = 0;
+    uint64_t original = recordSession(path, eventsWritten);
+
+    TraceReader reader;
+    expect(reader.open(path), "open recorded trace");
+
+    auto ignoreBlock = [](const ReplayBlock&) {};
+    ReplayResult first = replayTrace(reader, ignoreBlock);
+    ReplayResult second = replayTrace(reader, ignoreBlock);
+
+    expect(first.events == eventsWritten, "every written event is replayed");
+    expect(first.blocks == 400, "every block is replayed");
+    expect(!first.truncated && first.droppedEvents == 0, "trace is complete");
+    expect(first.checksum == original, "replay matches the original render");
+    expect(second.checksum == first.checksum, "replay is deterministic");
+}
+
+/// Attach the recorder while ramps are moving and queued; only the output
+/// rendered after attaching is compared
+uint64_t recordMidAutomation(const std::string& path, TraceRecorder& recorder) {
+    auto kernel = std::make_unique<M2DXKernel>();
+    kernel->initialize(48000.0f);
+    kernel->setAlgorithm(31);
+    kernel->setMasterVolume(0.2f);
+
+    std::vector<float> left(256);
+    std::vector<float> right(256);
+    kernel->scheduleParameterRamp(DX7::kMasterVolumeAddress, 0.9f, 0, 3000);
+    kernel->scheduleParameterRamp(DX7::getOperatorLevelAddress(0), 0.05f, 10, 2000, RampShape::Exponential);
+    kernel->scheduleParameterRamp(DX7::getOperatorRatioAddress(1), 3.5f, 0, 1500);
+    kernel->scheduleParameterRamp(DX7::getOperatorDetuneAddress(2), 20.0f, 1000, 500);
+    kernel->processBuffer(left.data(), right.data(), 256);
+
+    TraceWriter writer(recorder);
+    if (!expect(writer.start(path), "trace writer starts mid-automation")) return 0;
+    kernel->setTraceRecorder(&recorder);
+    kernel->processBuffer(left.data(), right.data(), 200);
+
+    OutputChecksum checksum;
+    for (int block = 0; block < 20; ++block) {
+        if (block == 0) kernel->noteOn(60, 100);
+        kernel->processBuffer(left.data(), right.data(), 256);
+        checksum.add(left.data(), 256);
+        checksum.add(right.data(), 256);
+    }
+
+    kernel->setTraceRecorder(nullptr);
+    kernel->noteOff(60);  // Detach is pending: not part of the trace
+    writer.stop();
+    return checksum.value();
+}
+
+void testAttachMidAutomation(const std::string& directory) {
+    TraceRecorder recorder(1 << 12);
+
+    // Events left in the ring by an earlier session must not leak into the next file
+    TraceEvent stale;
+    stale.type = TraceEventType::NoteOn;
+    stale.ints = {72, 127};
+    recorder.record(stale);
+
+    std::string path = directory + "/automation.m2dxtrace";
+    uint64_t original = recordMidAutomation(path, recorder);
+
+    TraceReader reader;
+    expect(reader.open(path), "open mid-automation trace");
+    TraceEvent first;
+    expect(reader.next(first) && first.type == TraceEventType::SampleRate,
+           "trace starts with the snapshot, not leftover events");
+    reader.rewind();
+
+    ReplayResult result = replayTrace(reader, [](const ReplayBlock&) {});
+    expect(result.blocks == 20, "every block after attaching is replayed");
+    expect(result.checksum == original, "replay continues ramps in progress and queued ramps");
+}
+
+/// A parameter observer thread posts setters while it attaches the recorder;
+/// only the render thread touches the recorder, and the replay of everything
+/// after the attach matches the live output
+void testAttachWhilePosting(const std::string& directory) {
+    constexpr int kFrames = 256;
+    auto kernel = std::make_unique<M2DXKernel>();
+    kernel->initialize(48000.0f);
+    kernel->setAlgorithm(4);
+
+    TraceRecorder recorder(1 << 14);
+    TraceWriter writer(recorder);
+    std::string path = directory + "/posting.m2dxtrace";
+    if (!expect(writer.start(path), "trace writer starts while posting")) return;
+
+    std::atomic<bool> posting{true};
+    std::thread observer([&] {
+        for (int i = 0; i < 4000; ++i) {
+            int op = i % kNumOperators;
+            if (i == 1000) kernel->setTraceRecorder(&recorder);
+            kernel->postParameter(DX7::getOperatorLevelAddress(op), 0.5f + 0.0001f * i);
+            kernel->postParameter(DX7::getOperatorFeedbackAddress(op), 0.0001f * i);
+            kernel->postParameter(DX7::getOperatorEGRateAddress(op, 1), 40.0f + 0.01f * i);
+            kernel->postOperatorEnvelopeLevels(op, 1.0f, 0.9f, 0.6f + 0.00005f * i, 0.0f);
+            std::this_thread::yield();
+        }
+        posting.store(false);
+    });
+
+    // Notes start once the recorder is attached: sounding notes are not in the snapshot
+    std::vector<std::vector<float>> blocks;
+    std::vector<float> left(kFrames);
+    std::vector<float> right(kFrames);
+    int blocksAfterNote = -1;
+    while (posting.load() || blocksAfterNote < 40) {
+        if (blocksAfterNote < 0 && writer.getEventsWritten() > 0) blocksAfterNote = 0;
+        if (blocksAfterNote >= 0 && blocksAfterNote % 8 == 0) {
+            kernel->noteOn(static_cast<uint8_t>(48 + blocksAfterNote % 24), 100);
+        }
+        kernel->processBuffer(left.data(), right.data(), kFrames);
+        blocks.push_back(left);
+        blocks.push_back(right);
+        if (blocksAfterNote >= 0) ++blocksAfterNote;
+    }
+    observer.join();
+    kernel->setTraceRecorder(nullptr);
+    kernel->processBuffer(left.data(), right.data(), kFrames);
+    writer.stop();
+    expect(recorder.getDroppedEvents() == 0, "recorder drops nothing while posting");
+
+    TraceReader reader;
+    expect(reader.open(path), "open posting trace");
+    ReplayResult result = replayTrace(reader, [](const ReplayBlock&) {});
+    size_t recordedBlocks = static_cast<size_t>(result.blocks);
+    if (!expect(recordedBlocks > 0 && recordedBlocks * 2 <= blocks.size(), "blocks after attaching are replayed")) {
+        return;
+    }
+
+    // The last recorded blocks are the live ones before detaching
+    OutputChecksum checksum;
+    for (size_t i = blocks.size() - recordedBlocks * 2; i < blocks.size(); ++i) {
+        checksum.add(blocks[i].data(), kFrames);
+    }
+    expect(result.checksum == checksum.value(), "replay matches the output rendered while posting");
+}
+
+} // namespace
+
+int main() {
+    char directoryTemplate[] = "/tmp/m2dx-trace-XXXXXX";
+    const char* directory = mkdtemp(directoryTemplate);
+    if (!directory) {
+        std::fprintf(stderr, "FAIL: cannot create trace directory\n");
+        return EXIT_FAILURE;
+    }
+
+    testEncodingRoundTrip(directory);
+    testRecorderDropsWhenFull();
+    testReplayIsBitExact(directory);
+    testAttachMidAutomation(directory);
+    testAttachWhilePosting(directory);
+
+    std::filesystem::remove_all(directory);
+    return Test::finish("trace record / replay");
+}
@@ -0,0 +1,136 @@
+// TraceReplayTool.cpp
+// m2dx-trace-replay: re-renders an event trace offline and reports per-block
+// render timing against the real-time budget.
+//
+// Usage: m2dx-trace-replay <trace> [--iterations N] [--csv <file>]
+
+#include "TraceReplay.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace M2DX;
+
+namespace {
+
+struct Options {
+    std::string tracePath;
+    std::string csvPath;
+    int iterations = 1;
+};
+
+void printUsage() {
+    std::fprintf(stderr, "usage: m2dx-trace-replay <trace> [--iterations N] [--csv <file>]\n");
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+            options.iterations = std::max(std::atoi(argv[++i]), 1);
+        } else if (std::strcmp(argv[i], "--csv") == 0 && i + 1 < argc) {
+            options.csvPath = argv[++i];
+        } else if (argv[i][0] != '-' && options.tracePath.empty()) {
+            options.tracePath = argv[i];
+        } else {
+            return false;
+        }
+    }
+    return !options.tracePath.empty();
+}
+
+double percentile(const std::vector<double>& sorted, double fraction) {
+    if (sorted.empty()) return 0.0;
+    size_t index = static_cast<size_t>(fraction * static_cast<double>(sorted.size() - 1) + 0.5);
+    return sorted[index];
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return EXIT_FAILURE;
+    }
+
+    TraceReader reader;
+    if (!reader.open(options.tracePath)) {
+        std::fprintf(stderr, "error: cannot read trace %s\n", options.tracePath.c_str());
+        return EXIT_FAILURE;
+    }
+
+    std::FILE* csv = nullptr;
+    if (!options.csvPath.empty()) {
+        csv = std::fopen(options.csvPath.c_str(), "w");
+        if (!csv) {
+            std::fprintf(stderr, "error: cannot create %s\n", options.csvPath.c_str());
+            return EXIT_FAILURE;
+        }
+        std::fprintf(csv, "iteration,block,frame,frames,sample_rate,render_us,budget_us\n");
+    }
+
+    uint64_t firstChecksum = 0;
+    bool deterministic = true;
+
+    for (int iteration = 1; iteration <= options.iterations; ++iteration) {
+        std::vector<double> blockMicros;
+        uint64_t overruns = 0;
+        double renderSeconds = 0.0;
+        double audioSeconds = 0.0;
+
+        ReplayResult result = replayTrace(reader, [&](const ReplayBlock& block) {
+            double budget = static_cast<double>(block.numFrames) / block.sampleRate;
+            if (block.seconds > budget) ++overruns;
+            renderSeconds += block.seconds;
+            audioSeconds += budget;
+            blockMicros.push_back(block.seconds * 1e6);
+
+            if (csv) {
+                std::fprintf(csv, "%d,%zu,%llu,%d,%.0f,%.3f,%.3f\n", iteration, blockMicros.size() - 1,
+                             static_cast<unsigned long long>(block.frame), block.numFrames,
+                             block.sampleRate, block.seconds * 1e6, budget * 1e6);
+            }
+        });
+
+        if (iteration == 1) {
+            firstChecksum = result.checksum;
+            std::printf("trace: %s\n", options.tracePath.c_str());
+            std::printf("events: %llu  blocks: %llu  frames: %llu\n",
+                        static_cast<unsigned long long>(result.events),
+                        static_cast<unsigned long long>(result.blocks),
+                        static_cast<unsigned long long>(result.frames));
+            if (result.droppedEvents > 0) {
+                std::printf("warning: recorder dropped %llu event(s); replay may diverge from the original\n",
+                            static_cast<unsigned long long>(result.droppedEvents));
+            }
+            if (result.truncated) {
+                std::printf("warning: trace ends with a truncated record\n");
+            }
+        } else if (result.checksum != firstChecksum) {
+            deterministic = false;
+        }
+
+        double mean = blockMicros.empty() ? 0.0 : renderSeconds * 1e6 / static_cast<double>(blockMicros.size());
+        std::sort(blockMicros.begin(), blockMicros.end());
+        std::printf("[%d] checksum %016llx  block us: mean %.2f p50 %.2f p99 %.2f max %.2f  "
+                    "overruns %llu/%llu  realtime x%.1f\n",
+                    iteration, static_cast<unsigned long long>(result.checksum), mean,
+                    percentile(blockMicros, 0.50), percentile(blockMicros, 0.99),
+                    blockMicros.empty() ? 0.0 : blockMicros.back(),
+                    static_cast<unsigned long long>(overruns),
+                    static_cast<unsigned long long>(result.blocks),
+                    renderSeconds > 0.0 ? audioSeconds / renderSeconds : 0.0);
+    }
+
+    if (csv) std::fclose(csv);
+
+    if (!deterministic) {
+        std::fprintf(stderr, "FAIL: output checksum differs between iterations\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -16,6 +16,8 @@ NS_ASSUME_NONNULL_BEGIN
 - (void)setSampleRate:(double)sampleRate;
 
 /// Set algorithm (0-63)
+/// Algorithm, master volume and operator level/ratio/detune/feedback/envelope
+/// may be set from any thread; they are applied at the start of the next render call.
 - (void)setAlgorithm:(int)algorithm;
 
 /// Set master volume (0.0-1.0)
@@ -39,6 +41,26 @@ NS_ASSUME_NONNULL_BEGIN
 /// Set operator envelope levels (0.0-1.0)
 - (void)setOperatorEnvelopeLevels:(int)operatorIndex l1:(float)l1 l2:(float)l2 l3:(float)l3 l4:(float)l4;
 
+/// Set operator keyboard level scaling (DX7 style: break point 0-99, depths 0-99, curves 0-3)
+/// Keyboard level scaling, rate scaling and velocity sensitivity rebuild the
+/// tables note-on reads and are not posted: call them only while rendering is
+/// stopped (patch load before allocateRenderResources).
+- (void)setOperatorKeyboardLevelScaling:(int)operatorIndex breakPoint:(int)breakPoint leftDepth:(int)leftDepth rightDepth:(int)rightDepth leftCurve:(int)leftCurve rightCurve:(int)rightCurve;
+
+/// Set operator keyboard rate scaling (0-7)
+- (void)setOperatorRateScaling:(int)operatorIndex rateScaling:(int)rateScaling;
+
+/// Set operator key velocity sensitivity (0-7)
+- (void)setOperatorVelocitySensitivity:(int)operatorIndex sensitivity:(int)sensitivity;
+
+/// Schedule a parameter ramp starting at a frame offset within the next render call
+/// Supports master volume and operator level/ratio/detune; returns NO for other addresses
+- (BOOL)scheduleParameterRamp:(int)address target:(float)value frameOffset:(int)frameOffset durationFrames:(int)durationFrames NS_SWIFT_NAME(scheduleParameterRamp(_:target:frameOffset:durationFrames:));
+
+/// Set a parameter by address immediately (render thread)
+/// Fallback for render-list parameter events that cannot be ramped; returns NO for unknown addresses
+- (BOOL)setParameter:(int)address value:(float)value NS_SWIFT_NAME(setParameter(_:value:));
+
 /// Handle MIDI note on
 - (void)handleNoteOn:(uint8_t)note velocity:(uint8_t)velocity NS_SWIFT_NAME(handleNoteOn(_:velocity:));
 
@@ -54,6 +76,42 @@ NS_ASSUME_NONNULL_BEGIN
 /// Get current active voice count
 - (int)activeVoiceCount;
 
+// MARK: - Output Capture
+
+/// Start capturing rendered output to WAV files in directory
+/// Rotates to a new file when either limit is reached (0 = unlimited)
+/// @return NO if capture is already running or the first file cannot be created
+- (BOOL)startCaptureToDirectory:(NSString *)directory maxFileBytes:(uint64_t)maxFileBytes maxFileSeconds:(double)maxFileSeconds;
+
+/// Stop capturing; drains buffered audio and finalizes the current file
+- (void)stopCapture;
+
+/// Whether output capture is running
+@property (nonatomic, readonly) BOOL isCapturing;
+
+/// Number of render blocks dropped because the capture ring was full
+@property (nonatomic, readonly) uint64_t captureOverrunCount;
+
+/// Whether the capture writer failed to create or write a file
+@property (nonatomic, readonly) BOOL captureHasWriteError;
+
+// MARK: - Event Trace
+
+/// Start recording every kernel event to a trace file for offline replay
+/// The current patch is written first so the trace replays from the same state;
+/// recording starts with the render call after the next one
+/// @return NO if recording is already running or the file cannot be created
+- (BOOL)startTraceRecordingToPath:(NSString *)path;
+
+/// Stop recording; drains buffered events and closes the file
+- (void)stopTraceRecording;
+
+/// Whether event trace recording is running
+@property (nonatomic, readonly) BOOL isTraceRecording;
+
+/// Number of events lost because the trace ring was full or contended
+@property (nonatomic, readonly) uint64_t traceDroppedEventCount;
+
 @end
 
 NS_ASSUME_NONNULL_END
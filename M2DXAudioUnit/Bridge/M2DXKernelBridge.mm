@@ -1,9 +1,25 @@
 #import "M2DXKernelBridge.h"
 #include "../DSP/M2DXKernel.hpp"
+#include "../DSP/CaptureWriter.hpp"
+#include "../DSP/TraceWriter.hpp"
 #include <memory>
 
+/// Capture ring capacity (~2.7 seconds at 48 kHz) to absorb writer stalls
+static constexpr size_t kCaptureRingFrames = 1 << 17;
+
+/// Trace ring capacity in events; a block marker per render call plus MIDI traffic
+static constexpr size_t kTraceRingEvents = 1 << 15;
+
 @implementation M2DXKernelBridge {
     std::unique_ptr<M2DX::M2DXKernel> _kernel;
+    // The ring is kept for the bridge lifetime so a render call that raced
+    // a detach never writes into freed memory
+    std::unique_ptr<M2DX::CaptureRing> _captureRing;
+    std::unique_ptr<M2DX::CaptureWriter> _captureWriter;
+    // Same lifetime rule as the capture ring
+    std::unique_ptr<M2DX::TraceRecorder> _traceRecorder;
+    std::unique_ptr<M2DX::TraceWriter> _traceWriter;
+    double _sampleRate;
 }
 
 - (instancetype)initWithSampleRate:(double)sampleRate {
@@ -11,6 +27,7 @@
     if (self) {
         _kernel = std::make_unique<M2DX::M2DXKernel>();
         _kernel->initialize(static_cast<float>(sampleRate));
+        _sampleRate = sampleRate;
 
         // Set default operator parameters for a basic FM piano-like sound
         // DX7 compatible: 6 operators
@@ -21,45 +38,82 @@
             _kernel->setOperatorFeedback(i, (i == 5) ? 0.3f : 0.0f);
             _kernel->setOperatorEnvelopeRates(i, 99.0f, 75.0f, 50.0f, 50.0f);
             _kernel->setOperatorEnvelopeLevels(i, 1.0f, 0.8f, 0.6f, 0.0f);
+            // Full velocity response on the carrier, lighter on modulators for brightness
+            _kernel->setOperatorVelocitySensitivity(i, (i == 0) ? 7 : 3);
         }
     }
     return self;
 }
 
+- (void)dealloc {
+    [self stopCapture];
+    [self stopTraceRecording];
+}
+
 - (void)setSampleRate:(double)sampleRate {
+    // Marks the rate change in the capture ring, if attached, so the writer switches files there
     _kernel->initialize(static_cast<float>(sampleRate));
+    _sampleRate = sampleRate;
 }
 
+// Called from the parameter observer thread; values reach the kernel at the next render call
+
 - (void)setAlgorithm:(int)algorithm {
-    _kernel->setAlgorithm(algorithm);
+    _kernel->postParameter(M2DX::DX7::kAlgorithmAddress, static_cast<float>(algorithm));
 }
 
 - (void)setMasterVolume:(float)volume {
-    _kernel->setMasterVolume(volume);
+    _kernel->postParameter(M2DX::DX7::kMasterVolumeAddress, volume);
 }
 
 - (void)setOperatorLevel:(int)operatorIndex level:(float)level {
-    _kernel->setOperatorLevel(operatorIndex, level);
+    if (operatorIndex < 0 || operatorIndex >= M2DX::DX7::kNumOperators) return;
+    _kernel->postParameter(M2DX::DX7::getOperatorLevelAddress(operatorIndex), level);
 }
 
 - (void)setOperatorRatio:(int)operatorIndex ratio:(float)ratio {
-    _kernel->setOperatorRatio(operatorIndex, ratio);
+    if (operatorIndex < 0 || operatorIndex >= M2DX::DX7::kNumOperators) return;
+    _kernel->postParameter(M2DX::DX7::getOperatorRatioAddress(operatorIndex), ratio);
 }
 
 - (void)setOperatorDetune:(int)operatorIndex detuneCents:(float)cents {
-    _kernel->setOperatorDetune(operatorIndex, cents);
+    if (operatorIndex < 0 || operatorIndex >= M2DX::DX7::kNumOperators) return;
+    _kernel->postParameter(M2DX::DX7::getOperatorDetuneAddress(operatorIndex), cents);
 }
 
 - (void)setOperatorFeedback:(int)operatorIndex feedback:(float)feedback {
-    _kernel->setOperatorFeedback(operatorIndex, feedback);
+    if (operatorIndex < 0 || operatorIndex >= M2DX::DX7::kNumOperators) return;
+    _kernel->postParameter(M2DX::DX7::getOperatorFeedbackAddress(operatorIndex), feedback);
 }
 
 - (void)setOperatorEnvelopeRates:(int)operatorIndex r1:(float)r1 r2:(float)r2 r3:(float)r3 r4:(float)r4 {
-    _kernel->setOperatorEnvelopeRates(operatorIndex, r1, r2, r3, r4);
+    _kernel->postOperatorEnvelopeRates(operatorIndex, r1, r2, r3, r4);
 }
 
 - (void)setOperatorEnvelopeLevels:(int)operatorIndex l1:(float)l1 l2:(float)l2 l3:(float)l3 l4:(float)l4 {
-    _kernel->setOperatorEnvelopeLevels(operatorIndex, l1, l2, l3, l4);
+    _kernel->postOperatorEnvelopeLevels(operatorIndex, l1, l2, l3, l4);
+}
+
+// Patch load only: rendering must be stopped (see header)
+
+- (void)setOperatorKeyboardLevelScaling:(int)operatorIndex breakPoint:(int)breakPoint leftDepth:(int)leftDepth rightDepth:(int)rightDepth leftCurve:(int)leftCurve rightCurve:(int)rightCurve {
+    _kernel->setOperatorKeyboardLevelScaling(operatorIndex, breakPoint, leftDepth, rightDepth, leftCurve, rightCurve);
+}
+
+- (void)setOperatorRateScaling:(int)operatorIndex rateScaling:(int)rateScaling {
+    _kernel->setOperatorRateScaling(operatorIndex, rateScaling);
+}
+
+- (void)setOperatorVelocitySensitivity:(int)operatorIndex sensitivity:(int)sensitivity {
+    _kernel->setOperatorVelocitySensitivity(operatorIndex, sensitivity);
+}
+
+- (BOOL)scheduleParameterRamp:(int)address target:(float)value frameOffset:(int)frameOffset durationFrames:(int)durationFrames {
+    return _kernel->scheduleParameterRamp(address, value, frameOffset, durationFrames);
+}
+
+- (BOOL)setParameter:(int)address value:(float)value {
+    return _kernel->setParameter(address, value);
 }
 
 - (void)handleNoteOn:(uint8_t)note velocity:(uint8_t)velocity {
@@ -82,4 +136,78 @@
     return _kernel->getActiveVoiceCount();
 }
 
+// MARK: - Output Capture
+
+- (BOOL)startCaptureToDirectory:(NSString *)directory maxFileBytes:(uint64_t)maxFileBytes maxFileSeconds:(double)maxFileSeconds {
+    if (_captureWriter && _captureWriter->isRunning()) {
+        return NO;
+    }
+    if (!_captureRing) {
+        _captureRing = std::make_unique<M2DX::CaptureRing>(kCaptureRingFrames);
+        _captureWriter = std::make_unique<M2DX::CaptureWriter>(*_captureRing);
+    }
+
+    M2DX::CaptureRotation rotation{maxFileBytes, maxFileSeconds};
+    if (!_captureWriter->start(directory.fileSystemRepresentation, "M2DX",
+                               static_cast<float>(_sampleRate), rotation)) {
+        return NO;
+    }
+    _kernel->setCaptureRing(_captureRing.get());
+    return YES;
+}
+
+- (void)stopCapture {
+    if (!_captureWriter) {
+        return;
+    }
+    _kernel->setCaptureRing(nullptr);
+    _captureWriter->stop();
+}
+
+- (BOOL)isCapturing {
+    return _captureWriter && _captureWriter->isRunning();
+}
+
+- (uint64_t)captureOverrunCount {
+    return _captureRing ? _captureRing->getOverrunCount() : 0;
+}
+
+- (BOOL)captureHasWriteError {
+    return _captureWriter && _captureWriter->hasWriteError();
+}
+
+// MARK: - Event Trace
+
+- (BOOL)startTraceRecordingToPath:(NSString *)path {
+    if (_traceWriter && _traceWriter->isRunning()) {
+        return NO;
+    }
+    if (!_traceRecorder) {
+        _traceRecorder = std::make_unique<M2DX::TraceRecorder>(kTraceRingEvents);
+        _traceWriter = std::make_unique<M2DX::TraceWriter>(*_traceRecorder);
+    }
+
+    if (!_traceWriter->start(path.fileSystemRepresentation)) {
+        return NO;
+    }
+    _kernel->setTraceRecorder(_traceRecorder.get());
+    return YES;
+}
+
+- (void)stopTraceRecording {
+    if (!_traceWriter) {
+        return;
+    }
+    _kernel->setTraceRecorder(nullptr);
+    _traceWriter->stop();
+}
+
+- (BOOL)isTraceRecording {
+    return _traceWriter && _traceWriter->isRunning();
+}
+
+- (uint64_t)traceDroppedEventCount {
+    return _traceRecorder ? _traceRecorder->getDroppedEvents() : 0;
+}
+
 @end
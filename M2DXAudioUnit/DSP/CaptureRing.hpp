@@ -0,0 +1,159 @@
+#ifndef CaptureRing_hpp
+#define CaptureRing_hpp
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace M2DX {
+
+/// Lock-free single-producer / single-consumer ring of stereo frames
+///
+/// Producer: render thread (write). Consumer: capture writer thread (read).
+/// Storage is allocated once in the constructor; write() never allocates,
+/// locks or blocks. A block that does not fit is dropped whole and counted
+/// as an overrun so the captured file never contains torn blocks.
+///
+/// Sample rate changes are queued as markers at the frame they take effect;
+/// read() stops at the next marker so the consumer can switch files exactly there.
+class CaptureRing {
+public:
+    /// @param capacityFrames Requested capacity (rounded up to a power of two)
+    explicit CaptureRing(size_t capacityFrames) {
+        capacity_ = 1;
+        while (capacity_ < capacityFrames) capacity_ <<= 1;
+        mask_ = capacity_ - 1;
+        samples_ = std::make_unique<float[]>(capacity_ * kChannels);
+    }
+
+    CaptureRing(const CaptureRing&) = delete;
+    CaptureRing& operator=(const CaptureRing&) = delete;
+
+    /// Producer: append one rendered block (render thread safe)
+    /// @return false if the block was dropped because the ring is full
+    bool write(const float* left, const float* right, int numFrames) {
+        size_t frames = static_cast<size_t>(std::max(numFrames, 0));
+        size_t writeIndex = writeIndex_.load(std::memory_order_relaxed);
+        size_t readIndex = readIndex_.load(std::memory_order_acquire);
+
+        if (frames > capacity_ - (writeIndex - readIndex)) {
+            overrunCount_.fetch_add(1, std::memory_order_relaxed);
+            droppedFrames_.fetch_add(frames, std::memory_order_relaxed);
+            return false;
+        }
+
+        for (size_t i = 0; i < frames; ++i) {
+            size_t slot = ((writeIndex + i) & mask_) * kChannels;
+            samples_[slot] = left[i];
+            samples_[slot + 1] = right[i];
+        }
+        writeIndex_.store(writeIndex + frames, std::memory_order_release);
+        return true;
+    }
+
+    /// Producer: frames written after this call were rendered at sampleRate
+    /// (call from the thread that calls write(), e.g. the kernel's initialize())
+    /// @return false if too many rate changes are waiting to be read
+    bool markSampleRate(float sampleRate) {
+        size_t markIndex = rateChangeWriteIndex_.load(std::memory_order_relaxed);
+        if (markIndex - rateChangeReadIndex_.load(std::memory_order_acquire) >= kMaxRateChanges) {
+            return false;
+        }
+        RateChange& change = rateChanges_[markIndex % kMaxRateChanges];
+        change.frame = writeIndex_.load(std::memory_order_relaxed);
+        change.sampleRate = sampleRate;
+        rateChangeWriteIndex_.store(markIndex + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Consumer: take a rate change that starts at the next frame to be read
+    /// @return false if the next frame keeps the current rate
+    bool popSampleRateChange(float& sampleRate) {
+        size_t markIndex = rateChangeReadIndex_.load(std::memory_order_relaxed);
+        if (markIndex == rateChangeWriteIndex_.load(std::memory_order_acquire)) return false;
+
+        const RateChange& change = rateChanges_[markIndex % kMaxRateChanges];
+        if (change.frame != readIndex_.load(std::memory_order_relaxed)) return false;
+        sampleRate = change.sampleRate;
+        rateChangeReadIndex_.store(markIndex + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Consumer: copy up to maxFrames interleaved stereo frames into destination,
+    /// stopping before the next pending rate change
+    /// @return Number of frames read
+    size_t read(float* destination, size_t maxFrames) {
+        size_t readIndex = readIndex_.load(std::memory_order_relaxed);
+        // Load the write index first: a marker published before these frames is then visible too
+        size_t writeIndex = writeIndex_.load(std::memory_order_acquire);
+        size_t frames = std::min(maxFrames, writeIndex - readIndex);
+
+        size_t markIndex = rateChangeReadIndex_.load(std::memory_order_relaxed);
+        if (markIndex != rateChangeWriteIndex_.load(std::memory_order_acquire)) {
+            frames = std::min(frames, rateChanges_[markIndex % kMaxRateChanges].frame - readIndex);
+        }
+
+        for (size_t i = 0; i < frames; ++i) {
+            size_t slot = ((readIndex + i) & mask_) * kChannels;
+            destination[i * kChannels] = samples_[slot];
+            destination[i * kChannels + 1] = samples_[slot + 1];
+        }
+        readIndex_.store(readIndex + frames, std::memory_order_release);
+        return frames;
+    }
+
+    /// Consumer: drop every queued frame and the rate changes that applied to them
+    /// A rate change marked at the current write position is kept, so it still
+    /// applies to the frames written after it.
+    void discard() {
+        size_t markEnd = rateChangeWriteIndex_.load(std::memory_order_acquire);
+        // Markers loaded above are at or before this write index
+        size_t writeIndex = writeIndex_.load(std::memory_order_acquire);
+
+        size_t markIndex = rateChangeReadIndex_.load(std::memory_order_relaxed);
+        while (markIndex != markEnd && rateChanges_[markIndex % kMaxRateChanges].frame < writeIndex) {
+            ++markIndex;
+        }
+        rateChangeReadIndex_.store(markIndex, std::memory_order_release);
+        readIndex_.store(writeIndex, std::memory_order_release);
+    }
+
+    /// Frames waiting to be read (approximate when called off the consumer thread)
+    size_t getAvailableFrames() const {
+        return writeIndex_.load(std::memory_order_acquire) - readIndex_.load(std::memory_order_acquire);
+    }
+
+    size_t getCapacityFrames() const { return capacity_; }
+    uint64_t getOverrunCount() const { return overrunCount_.load(std::memory_order_relaxed); }
+    uint64_t getDroppedFrames() const { return droppedFrames_.load(std::memory_order_relaxed); }
+
+    static constexpr int kChannels = 2;
+    /// Rate changes that may wait for the consumer at once
+    static constexpr size_t kMaxRateChanges = 8;
+
+private:
+    struct RateChange {
+        size_t frame = 0;
+        float sampleRate = 0.0f;
+    };
+
+    size_t capacity_ = 0;
+    size_t mask_ = 0;
+    std::unique_ptr<float[]> samples_;
+
+    // Monotonic frame counters; separate cache lines avoid producer/consumer false sharing
+    alignas(64) std::atomic<size_t> writeIndex_{0};
+    alignas(64) std::atomic<size_t> readIndex_{0};
+    alignas(64) std::atomic<uint64_t> overrunCount_{0};
+    std::atomic<uint64_t> droppedFrames_{0};
+
+    RateChange rateChanges_[kMaxRateChanges];
+    alignas(64) std::atomic<size_t> rateChangeWriteIndex_{0};
+    alignas(64) std::atomic<size_t> rateChangeReadIndex_{0};
+};
+
+} // namespace M2DX
+
+#endif /* CaptureRing_hpp */
@@ -0,0 +1,262 @@
+#ifndef CaptureWriter_hpp
+#define CaptureWriter_hpp
+
+#include "CaptureRing.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace M2DX {
+
+/// File rotation limits for the capture writer (0 = unlimited)
+struct CaptureRotation {
+    uint64_t maxFileBytes = 0;
+    double maxFileSeconds = 0.0;
+};
+
+/// Background thread that drains a CaptureRing into streaming WAV files
+///
+/// Files are 32-bit float stereo WAV named "<prefix>-YYYYMMDD-HHMMSS-SS-NNNN.wav",
+/// where SS numbers sessions started within the same second and NNNN numbers
+/// the files of one session. Files are created exclusively, so a new session
+/// never overwrites an earlier one.
+/// The header sizes are patched about once per second, so a file cut short
+/// by a crash is still readable up to the last update.
+/// A sample rate change marked in the ring starts a new file at exactly that frame.
+/// All file I/O and allocation happens on the writer thread.
+class CaptureWriter {
+public:
+    explicit CaptureWriter(CaptureRing& ring) : ring_(ring) {}
+
+    ~CaptureWriter() { stop(); }
+
+    CaptureWriter(const CaptureWriter&) = delete;
+    CaptureWriter& operator=(const CaptureWriter&) = delete;
+
+    /// Start writing into directory
+    /// Frames left in the ring by an earlier session are discarded: their rate
+    /// may no longer match. A rate change marked after them still applies.
+    /// @param sampleRate Rate of the frames written to the ring from now on
+    /// @return false if already running, maxFileBytes cannot hold a single frame
+    ///         or the first file cannot be created
+    bool start(const std::string& directory, const std::string& prefix,
+               float sampleRate, CaptureRotation rotation = {}) {
+        if (running_.load()) return false;
+        if (rotation.maxFileBytes > 0 && rotation.maxFileBytes < kBytesPerFrame) return false;
+
+        directory_ = directory;
+        prefix_ = prefix;
+        rotation_ = rotation;
+        sampleRate_ = sampleRate;
+        writeError_.store(false);
+
+        // The writer thread is not running, so this thread is the consumer
+        ring_.discard();
+        while (ring_.popSampleRateChange(sampleRate)) {
+            sampleRate_ = sampleRate;
+        }
+
+        std::time_t now = std::time(nullptr);
+        char stamp[32];
+        std::strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", std::localtime(&now));
+
+        // Sessions started within the same second get the next free session number
+        for (unsigned session = 0;; ++session) {
+            char suffix[8];
+            std::snprintf(suffix, sizeof(suffix), "-%02u", session);
+            sessionStamp_ = std::string(stamp) + suffix;
+            fileIndex_ = 0;
+            if (openNextFile()) break;
+            if (errno != EEXIST || session + 1 >= kMaxSessionsPerSecond) return false;
+        }
+
+        running_.store(true);
+        thread_ = std::thread([this] { run(); });
+        return true;
+    }
+
+    /// Drain the ring, finalize the current file and join the thread
+    void stop() {
+        if (!running_.exchange(false)) return;
+        if (thread_.joinable()) thread_.join();
+    }
+
+    bool isRunning() const { return running_.load(); }
+    bool hasWriteError() const { return writeError_.load(); }
+    uint64_t getFramesWritten() const { return totalFramesWritten_.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr size_t kChunkFrames = 4096;
+    static constexpr unsigned kMaxSessionsPerSecond = 100;
+    static constexpr uint32_t kHeaderBytes = 44;
+    static constexpr uint32_t kBytesPerFrame = CaptureRing::kChannels * sizeof(float);
+    /// RIFF sizes are 32-bit
+    static constexpr uint64_t kMaxDataBytes = 0xFFFFFFFFull - kHeaderBytes;
+
+    void run() {
+        std::vector<float> chunk(kChunkFrames * CaptureRing::kChannels);
+        auto lastHeaderUpdate = std::chrono::steady_clock::now();
+
+        while (true) {
+            bool stopping = !running_.load();
+            float sampleRate;
+            while (ring_.popSampleRateChange(sampleRate)) {
+                sampleRate_ = sampleRate;
+            }
+            size_t frames = ring_.read(chunk.data(), kChunkFrames);
+
+            if (frames > 0) {
+                writeFrames(chunk.data(), frames);
+            } else if (stopping) {
+                break;
+            } else {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+
+            auto now = std::chrono::steady_clock::now();
+            if (now - lastHeaderUpdate >= std::chrono::seconds(1)) {
+                updateHeader();
+                lastHeaderUpdate = now;
+            }
+        }
+        closeFile();
+    }
+
+    void writeFrames(const float* samples, size_t frames) {
+        if (!file_) return;
+
+        if (sampleRate_ != fileSampleRate_) {
+            if (!rotate()) return;
+        }
+
+        // start() guarantees the byte limit holds at least one frame
+        uint64_t byteLimit = rotation_.maxFileBytes > 0
+            ? std::min<uint64_t>(rotation_.maxFileBytes, kMaxDataBytes) : kMaxDataBytes;
+        uint64_t frameLimit = rotation_.maxFileSeconds > 0.0
+            ? static_cast<uint64_t>(rotation_.maxFileSeconds * fileSampleRate_) : 0;
+
+        while (frames > 0 && file_) {
+            uint64_t writable = frames;
+            uint64_t byteRoom = dataBytes_ < byteLimit ? byteLimit - dataBytes_ : 0;
+            writable = std::min<uint64_t>(writable, byteRoom / kBytesPerFrame);
+            // A time limit shorter than one frame at this rate is ignored rather than spinning
+            if (frameLimit > 0) {
+                writable = std::min<uint64_t>(writable, frameLimit > fileFrames_ ? frameLimit - fileFrames_ : 0);
+            }
+
+            if (writable == 0) {
+                if (fileFrames_ == 0 || !rotate()) return;
+                continue;
+            }
+
+            if (std::fwrite(samples, kBytesPerFrame, static_cast<size_t>(writable), file_) != writable) {
+                writeError_.store(true);
+                closeFile();
+                return;
+            }
+            samples += writable * CaptureRing::kChannels;
+            frames -= writable;
+            fileFrames_ += writable;
+            dataBytes_ += writable * kBytesPerFrame;
+            totalFramesWritten_.fetch_add(writable, std::memory_order_relaxed);
+        }
+    }
+
+    bool rotate() {
+        closeFile();
+        if (!openNextFile()) {
+            writeError_.store(true);
+            return false;
+        }
+        return true;
+    }
+
+    bool openNextFile() {
+        char suffix[16];
+        std::snprintf(suffix, sizeof(suffix), "-%04u.wav", fileIndex_++);
+        std::string path = directory_ + "/" + prefix_ + "-" + sessionStamp_ + suffix;
+
+        // "x": fail with EEXIST instead of truncating an existing capture
+        file_ = std::fopen(path.c_str(), "wbx");
+        if (!file_) return false;
+
+        fileSampleRate_ = sampleRate_;
+        fileFrames_ = 0;
+        dataBytes_ = 0;
+        writeHeader();
+        return true;
+    }
+
+    void closeFile() {
+        if (!file_) return;
+        updateHeader();
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+
+    void updateHeader() {
+        if (!file_) return;
+        long position = std::ftell(file_);
+        std::fseek(file_, 0, SEEK_SET);
+        writeHeader();
+        std::fseek(file_, position, SEEK_SET);
+        std::fflush(file_);
+    }
+
+    /// Canonical 44-byte WAVE_FORMAT_IEEE_FLOAT header
+    void writeHeader() {
+        uint32_t dataBytes = static_cast<uint32_t>(dataBytes_);
+        uint32_t sampleRate = static_cast<uint32_t>(fileSampleRate_);
+        uint8_t header[kHeaderBytes];
+        uint8_t* p = header;
+
+        auto put4cc = [&p](const char* tag) { for (int i = 0; i < 4; ++i) *p++ = static_cast<uint8_t>(tag[i]); };
+        auto put16 = [&p](uint16_t v) { *p++ = v & 0xFF; *p++ = (v >> 8) & 0xFF; };
+        auto put32 = [&p](uint32_t v) { for (int i = 0; i < 4; ++i) *p++ = (v >> (8 * i)) & 0xFF; };
+
+        put4cc("RIFF");
+        put32(kHeaderBytes - 8 + dataBytes);
+        put4cc("WAVE");
+        put4cc("fmt ");
+        put32(16);
+        put16(3);                                   // WAVE_FORMAT_IEEE_FLOAT
+        put16(CaptureRing::kChannels);
+        put32(sampleRate);
+        put32(sampleRate * kBytesPerFrame);         // Byte rate
+        put16(kBytesPerFrame);                      // Block align
+        put16(32);                                  // Bits per sample
+        put4cc("data");
+        put32(dataBytes);
+
+        std::fwrite(header, 1, kHeaderBytes, file_);
+    }
+
+    CaptureRing& ring_;
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    std::atomic<bool> writeError_{false};
+    std::atomic<uint64_t> totalFramesWritten_{0};
+
+    // Writer thread state
+    std::string directory_;
+    std::string prefix_;
+    std::string sessionStamp_;
+    CaptureRotation rotation_;
+    float sampleRate_ = 44100.0f;
+    std::FILE* file_ = nullptr;
+    unsigned fileIndex_ = 0;
+    float fileSampleRate_ = 44100.0f;
+    uint64_t fileFrames_ = 0;
+    uint64_t dataBytes_ = 0;
+};
+
+} // namespace M2DX
+
+#endif /* CaptureWriter_hpp */
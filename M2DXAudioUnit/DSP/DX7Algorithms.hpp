@@ -0,0 +1,130 @@
+#ifndef DX7Algorithms_hpp
+#define DX7Algorithms_hpp
+
+#include "DX7Constants.hpp"
+#include <array>
+#include <cstdint>
+
+namespace M2DX {
+
+/// One operator in an algorithm's processing order
+struct OperatorRoute {
+    uint8_t op = 0;          // Operator index (0 = OP1)
+    uint8_t modulators = 0;  // Bitmask of operators whose outputs are summed into this one
+    bool carrier = false;    // Output goes to the voice mix
+};
+
+/// Operator routing for one algorithm
+/// Routes are listed so that every modulator comes before the operators it feeds.
+struct AlgorithmRouting {
+    std::array<OperatorRoute, DX7::kNumOperators> routes;
+    float outputScale;       // Carrier sum normalization
+};
+
+/// Pruned processing order for the active patch
+/// Only operators that can reach the output are listed, in routing order.
+struct OperatorSchedule {
+    std::array<OperatorRoute, DX7::kNumOperators> steps{};
+    int numSteps = 0;
+    float outputScale = 1.0f;
+    const AlgorithmRouting* routing = nullptr;  // Full routing when nothing was pruned
+};
+
+namespace DX7 {
+
+constexpr uint8_t operatorBit(int op) { return static_cast<uint8_t>(1u << op); }
+
+/// Bitmask with all operators set
+constexpr uint8_t kAllOperators = (1u << kNumOperators) - 1;
+
+// DX7 Algorithm 1: OP6->5->4->3->2->1 (serial, carrier: OP1)
+inline constexpr AlgorithmRouting kAlgorithm1 = {{{
+    {5, 0, false},
+    {4, operatorBit(5), false},
+    {3, operatorBit(4), false},
+    {2, operatorBit(3), false},
+    {1, operatorBit(2), false},
+    {0, operatorBit(1), true},
+}}, 1.0f};
+
+// DX7 Algorithm 2: (OP6->5->4->3->2) + OP1 (carriers: OP1, OP2)
+inline constexpr AlgorithmRouting kAlgorithm2 = {{{
+    {5, 0, false},
+    {4, operatorBit(5), false},
+    {3, operatorBit(4), false},
+    {2, operatorBit(3), false},
+    {1, operatorBit(2), true},
+    {0, 0, true},
+}}, 0.5f};
+
+// DX7 Algorithm 5: Parallel pairs (OP6->5, OP4->3, OP2->1)
+inline constexpr AlgorithmRouting kAlgorithm5 = {{{
+    {5, 0, false},
+    {4, operatorBit(5), true},
+    {3, 0, false},
+    {2, operatorBit(3), true},
+    {1, 0, false},
+    {0, operatorBit(1), true},
+}}, 0.33f};
+
+// DX7 Algorithm 32: All carriers parallel
+inline constexpr AlgorithmRouting kAlgorithm32 = {{{
+    {0, 0, true},
+    {1, 0, true},
+    {2, 0, true},
+    {3, 0, true},
+    {4, 0, true},
+    {5, 0, true},
+}}, 1.0f / static_cast<float>(kNumOperators)};
+
+/// Routing for an algorithm index (0-31)
+/// Currently implementing representative algorithms
+/// TODO: Implement all 32 DX7 algorithms
+inline const AlgorithmRouting& getAlgorithmRouting(int algorithm) {
+    switch (algorithm) {
+        case 1:  return kAlgorithm2;
+        case 4:  return kAlgorithm5;
+        case 31: return kAlgorithm32;
+        default: return kAlgorithm1;  // Algorithm 1, also used for unimplemented
+    }
+}
+
+/// Build the pruned schedule for an algorithm
+/// @param algorithm Algorithm index (0-31)
+/// @param audible Bitmask of operators that can produce output (e.g. level > 0)
+///
+/// An operator is kept if it is audible and is either a carrier or modulates
+/// a kept operator, so a silent modulator drops out together with its whole
+/// upstream chain.
+inline OperatorSchedule buildOperatorSchedule(int algorithm, uint8_t audible) {
+    const AlgorithmRouting& routing = getAlgorithmRouting(algorithm);
+
+    // Walk from the output back up the chains
+    uint8_t kept = 0;
+    uint8_t needed = 0;
+    for (int i = kNumOperators - 1; i >= 0; --i) {
+        const OperatorRoute& route = routing.routes[i];
+        uint8_t bit = operatorBit(route.op);
+        if ((audible & bit) && (route.carrier || (needed & bit))) {
+            kept |= bit;
+            needed |= route.modulators;
+        }
+    }
+
+    OperatorSchedule schedule;
+    schedule.outputScale = routing.outputScale;
+    for (const auto& route : routing.routes) {
+        if (kept & operatorBit(route.op)) {
+            schedule.steps[schedule.numSteps++] = route;
+        }
+    }
+    if (kept == kAllOperators) {
+        schedule.routing = &routing;
+    }
+    return schedule;
+}
+
+} // namespace DX7
+} // namespace M2DX
+
+#endif /* DX7Algorithms_hpp */
@@ -38,6 +38,31 @@ constexpr float kEnvelopeMaxLevel = 1.0f;
 /// Number of envelope stages (Attack, Decay1, Decay2, Release)
 constexpr int kEnvelopeStages = 4;
 
+// ============================================================================
+// MARK: - Keyboard / Velocity Scaling Constants
+// ============================================================================
+
+/// Number of MIDI notes / velocity values covered by scaling tables
+constexpr int kNumMIDINotes = 128;
+
+/// Maximum keyboard level scaling depth (DX7: 0-99)
+constexpr int kMaxKeyboardScalingDepth = 99;
+
+/// Maximum keyboard level scaling break point (DX7: 0-99, 0 = A-1, 39 = C3)
+constexpr int kMaxKeyboardScalingBreakPoint = 99;
+
+/// Maximum keyboard rate scaling (DX7: 0-7)
+constexpr int kMaxRateScaling = 7;
+
+/// Maximum key velocity sensitivity (DX7: 0-7)
+constexpr int kMaxVelocitySensitivity = 7;
+
+/// Number of keyboard rate scaling groups (notes are grouped by 3 semitones)
+constexpr int kRateScalingGroups = 32;
+
+/// Output level step size in dB (DX7: 99 levels over ~74 dB)
+constexpr float kOutputLevelStepDB = 0.75f;
+
 // ============================================================================
 // MARK: - Feedback Constants
 // ============================================================================
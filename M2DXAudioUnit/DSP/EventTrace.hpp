@@ -0,0 +1,321 @@
+#ifndef EventTrace_hpp
+#define EventTrace_hpp
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace M2DX {
+
+// ============================================================================
+// MARK: - Trace Events
+// ============================================================================
+
+/// Kernel call recorded in an event trace
+/// Values are part of the file format; append new types at the end.
+enum class TraceEventType : uint8_t {
+    Block = 0,                     // ints: numFrames
+    SampleRate,                    // values: sampleRate
+    NoteOn,                        // ints: note, velocity
+    NoteOff,                       // ints: note
+    AllNotesOff,
+    Algorithm,                     // ints: algorithm
+    MasterVolume,                  // values: volume
+    OperatorLevel,                 // ints: op       values: level
+    OperatorRatio,                 // ints: op       values: ratio
+    OperatorDetune,                // ints: op       values: cents
+    OperatorFeedback,              // ints: op       values: feedback
+    OperatorEnvelopeRates,         // ints: op       values: r1-r4
+    OperatorEnvelopeLevels,        // ints: op       values: l1-l4
+    OperatorKeyboardLevelScaling,  // ints: op, breakPoint, leftDepth, rightDepth, leftCurve, rightCurve
+    OperatorRateScaling,           // ints: op, rateScaling
+    OperatorVelocitySensitivity,   // ints: op, sensitivity
+    ParameterRamp,                 // ints: address, frameOffset, durationFrames, shape  values: target
+    Dropped,                       // ints: number of events lost before this one
+    RampState,                     // ints: address, remainingFrames, exponential  values: current, target, step, logCurrent
+    Count
+};
+
+/// Number of int / float arguments stored in the file for each event type
+struct TracePayload {
+    uint8_t ints;
+    uint8_t values;
+};
+
+constexpr TracePayload kTracePayloads[] = {
+    {1, 0},  // Block
+    {0, 1},  // SampleRate
+    {2, 0},  // NoteOn
+    {1, 0},  // NoteOff
+    {0, 0},  // AllNotesOff
+    {1, 0},  // Algorithm
+    {0, 1},  // MasterVolume
+    {1, 1},  // OperatorLevel
+    {1, 1},  // OperatorRatio
+    {1, 1},  // OperatorDetune
+    {1, 1},  // OperatorFeedback
+    {1, 4},  // OperatorEnvelopeRates
+    {1, 4},  // OperatorEnvelopeLevels
+    {6, 0},  // OperatorKeyboardLevelScaling
+    {2, 0},  // OperatorRateScaling
+    {2, 0},  // OperatorVelocitySensitivity
+    {4, 1},  // ParameterRamp
+    {1, 0},  // Dropped
+    {3, 4},  // RampState
+};
+static_assert(sizeof(kTracePayloads) / sizeof(kTracePayloads[0]) == static_cast<size_t>(TraceEventType::Count),
+              "kTracePayloads must list every TraceEventType");
+
+/// Fixed-size event as stored in the recorder ring
+struct TraceEvent {
+    uint64_t frame = 0;  // Kernel frame position (frames rendered since recording started)
+    TraceEventType type = TraceEventType::Block;
+    std::array<int32_t, 6> ints{};
+    std::array<float, 4> values{};
+};
+
+// ============================================================================
+// MARK: - Recorder
+// ============================================================================
+
+/// Preallocated event ring filled by the kernel and drained by a TraceWriter
+///
+/// record() never allocates, locks or blocks. Kernel calls normally come from
+/// the render thread, but parameter setters may arrive from another thread;
+/// producers claim the ring with an atomic flag and an event that loses the
+/// race is counted as dropped instead of waiting.
+class TraceRecorder {
+public:
+    /// @param capacityEvents Requested capacity (rounded up to a power of two)
+    explicit TraceRecorder(size_t capacityEvents) {
+        capacity_ = 1;
+        while (capacity_ < capacityEvents) capacity_ <<= 1;
+        mask_ = capacity_ - 1;
+        events_ = std::make_unique<TraceEvent[]>(capacity_);
+    }
+
+    TraceRecorder(const TraceRecorder&) = delete;
+    TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+    /// Producer: append an event
+    /// @return false if the event was dropped
+    bool record(const TraceEvent& event) {
+        if (producerBusy_.exchange(true, std::memory_order_acquire)) {
+            pendingDropped_.fetch_add(1, std::memory_order_relaxed);
+            droppedEvents_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        size_t writeIndex = writeIndex_.load(std::memory_order_relaxed);
+        size_t freeSlots = capacity_ - (writeIndex - readIndex_.load(std::memory_order_acquire));
+
+        // Report earlier losses in-stream so a replay knows the trace has a gap
+        uint32_t pending = pendingDropped_.exchange(0, std::memory_order_relaxed);
+        bool recorded = false;
+        if (freeSlots >= (pending > 0 ? 2u : 1u)) {
+            if (pending > 0) {
+                TraceEvent dropped;
+                dropped.frame = event.frame;
+                dropped.type = TraceEventType::Dropped;
+                dropped.ints[0] = static_cast<int32_t>(pending);
+                events_[writeIndex++ & mask_] = dropped;
+            }
+            events_[writeIndex++ & mask_] = event;
+            writeIndex_.store(writeIndex, std::memory_order_release);
+            recorded = true;
+        } else {
+            pendingDropped_.fetch_add(pending + 1, std::memory_order_relaxed);
+        }
+
+        producerBusy_.store(false, std::memory_order_release);
+        if (!recorded) droppedEvents_.fetch_add(1, std::memory_order_relaxed);
+        return recorded;
+    }
+
+    /// Consumer: pop the oldest event
+    bool pop(TraceEvent& event) {
+        size_t readIndex = readIndex_.load(std::memory_order_relaxed);
+        if (readIndex == writeIndex_.load(std::memory_order_acquire)) return false;
+        event = events_[readIndex & mask_];
+        readIndex_.store(readIndex + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Consumer: discard everything queued, including a gap not yet reported
+    /// (e.g. events recorded after the previous writer stopped)
+    void clear() {
+        TraceEvent event;
+        while (pop(event)) {}
+        pendingDropped_.store(0, std::memory_order_relaxed);
+    }
+
+    uint64_t getDroppedEvents() const { return droppedEvents_.load(std::memory_order_relaxed); }
+
+private:
+    size_t capacity_ = 0;
+    size_t mask_ = 0;
+    std::unique_ptr<TraceEvent[]> events_;
+
+    alignas(64) std::atomic<size_t> writeIndex_{0};
+    alignas(64) std::atomic<size_t> readIndex_{0};
+    alignas(64) std::atomic<bool> producerBusy_{false};
+    std::atomic<uint32_t> pendingDropped_{0};
+    std::atomic<uint64_t> droppedEvents_{0};
+};
+
+// ============================================================================
+// MARK: - File Format
+// ============================================================================
+//
+// Header: "M2DXTRC" + version byte
+// Record: type (1 byte)
+//         frame delta from previous record (zigzag varint)
+//         ints (zigzag varints, count from kTracePayloads)
+//         values (IEEE 754 float32, little-endian, count from kTracePayloads)
+//
+// A note-on is typically 4 bytes and a block marker 3-4 bytes.
+
+constexpr char kTraceMagic[7] = {'M', '2', 'D', 'X', 'T', 'R', 'C'};
+constexpr uint8_t kTraceVersion = 1;
+constexpr size_t kTraceHeaderBytes = sizeof(kTraceMagic) + 1;
+
+/// Serializes events into the compact on-disk encoding
+class TraceEncoder {
+public:
+    static void appendHeader(std::vector<uint8_t>& out) {
+        for (char c : kTraceMagic) out.push_back(static_cast<uint8_t>(c));
+        out.push_back(kTraceVersion);
+    }
+
+    void append(const TraceEvent& event, std::vector<uint8_t>& out) {
+        const TracePayload& payload = kTracePayloads[static_cast<size_t>(event.type)];
+        out.push_back(static_cast<uint8_t>(event.type));
+        appendSigned(static_cast<int64_t>(event.frame - lastFrame_), out);
+        lastFrame_ = event.frame;
+
+        for (int i = 0; i < payload.ints; ++i) {
+            appendSigned(event.ints[i], out);
+        }
+        for (int i = 0; i < payload.values; ++i) {
+            uint32_t bits;
+            std::memcpy(&bits, &event.values[i], sizeof(bits));
+            for (int b = 0; b < 4; ++b) out.push_back(static_cast<uint8_t>(bits >> (8 * b)));
+        }
+    }
+
+private:
+    static void appendSigned(int64_t value, std::vector<uint8_t>& out) {
+        uint64_t zigzag = (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+        while (zigzag >= 0x80) {
+            out.push_back(static_cast<uint8_t>(zigzag | 0x80));
+            zigzag >>= 7;
+        }
+        out.push_back(static_cast<uint8_t>(zigzag));
+    }
+
+    uint64_t lastFrame_ = 0;
+};
+
+/// Reads a trace file written by TraceWriter (offline use)
+class TraceReader {
+public:
+    /// Load a trace file
+    /// @return false if the file cannot be read or has no valid header
+    bool open(const std::string& path) {
+        std::FILE* file = std::fopen(path.c_str(), "rb");
+        if (!file) return false;
+
+        data_.clear();
+        uint8_t buffer[65536];
+        size_t count;
+        while ((count = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+            data_.insert(data_.end(), buffer, buffer + count);
+        }
+        std::fclose(file);
+
+        if (data_.size() < kTraceHeaderBytes ||
+            std::memcmp(data_.data(), kTraceMagic, sizeof(kTraceMagic)) != 0 ||
+            data_[sizeof(kTraceMagic)] != kTraceVersion) {
+            return false;
+        }
+        rewind();
+        return true;
+    }
+
+    void rewind() {
+        position_ = kTraceHeaderBytes;
+        frame_ = 0;
+        truncated_ = false;
+    }
+
+    /// Decode the next event
+    /// @return false at end of trace, or if the last record is truncated (see isTruncated())
+    bool next(TraceEvent& event) {
+        if (position_ >= data_.size()) return false;
+
+        size_t start = position_;
+        uint8_t type = data_[position_++];
+        int64_t delta;
+        if (type >= static_cast<uint8_t>(TraceEventType::Count) || !readSigned(delta)) {
+            return fail(start);
+        }
+
+        event = TraceEvent{};
+        event.type = static_cast<TraceEventType>(type);
+        frame_ += static_cast<uint64_t>(delta);
+        event.frame = frame_;
+
+        const TracePayload& payload = kTracePayloads[type];
+        for (int i = 0; i < payload.ints; ++i) {
+            int64_t value;
+            if (!readSigned(value)) return fail(start);
+            event.ints[i] = static_cast<int32_t>(value);
+        }
+        for (int i = 0; i < payload.values; ++i) {
+            if (data_.size() - position_ < 4) return fail(start);
+            uint32_t bits = 0;
+            for (int b = 0; b < 4; ++b) bits |= static_cast<uint32_t>(data_[position_++]) << (8 * b);
+            std::memcpy(&event.values[i], &bits, sizeof(bits));
+        }
+        return true;
+    }
+
+    /// The trace ended in the middle of a record (e.g. the writer was killed)
+    bool isTruncated() const { return truncated_; }
+
+private:
+    bool readSigned(int64_t& value) {
+        uint64_t zigzag = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (position_ >= data_.size()) return false;
+            uint8_t byte = data_[position_++];
+            zigzag |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) {
+                value = static_cast<int64_t>(zigzag >> 1) ^ -static_cast<int64_t>(zigzag & 1);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool fail(size_t recordStart) {
+        position_ = data_.size();
+        truncated_ = recordStart < data_.size();
+        return false;
+    }
+
+    std::vector<uint8_t> data_;
+    size_t position_ = kTraceHeaderBytes;
+    uint64_t frame_ = 0;
+    bool truncated_ = false;
+};
+
+} // namespace M2DX
+
+#endif /* EventTrace_hpp */
@@ -2,12 +2,18 @@
 #define FMOperator_hpp
 
 #include "DX7Constants.hpp"
+#include <algorithm>
+#include <array>
 #include <cmath>
 #include <cstdint>
 
 namespace M2DX {
 
+/// Per-stage envelope coefficients (R1-R4)
+using EnvelopeCoefficients = std::array<float, DX7::kEnvelopeStages>;
+
 /// DX7-style envelope generator with 4 rates and 4 levels
+/// Rates arrive as per-stage coefficients computed by OperatorScaling.
 class Envelope {
 public:
     enum class Stage {
@@ -19,20 +25,22 @@ public:
         Release   // R4 -> L4 (usually 0)
     };
 
-    void setRates(float r1, float r2, float r3, float r4) {
-        rates_[0] = r1; rates_[1] = r2;
-        rates_[2] = r3; rates_[3] = r4;
-        recalculateCoefficients();
-    }
-
     void setLevels(float l1, float l2, float l3, float l4) {
         levels_[0] = l1; levels_[1] = l2;
         levels_[2] = l3; levels_[3] = l4;
     }
 
-    void setSampleRate(float sampleRate) {
-        sampleRate_ = sampleRate;
-        recalculateCoefficients();
+    /// Use precomputed coefficients (e.g. with keyboard rate scaling applied)
+    void setCoefficients(const EnvelopeCoefficients& coefficients) {
+        coefficients_ = coefficients;
+    }
+
+    /// Convert DX7 rate (0-99) to a per-sample coefficient
+    /// Higher rate = faster envelope
+    static float rateToCoefficient(float rate, float sampleRate) {
+        // DX7-style rate scaling
+        float timeInSeconds = 10.0f * std::exp(-0.069f * rate);
+        return 1.0f - std::exp(-1.0f / (timeInSeconds * sampleRate));
     }
 
     void noteOn() {
@@ -93,23 +101,11 @@ public:
 
     bool isActive() const { return stage_ != Stage::Idle; }
     Stage getStage() const { return stage_; }
+    float getLevel(int stage) const { return levels_[stage]; }
 
 private:
-    void recalculateCoefficients() {
-        // Convert DX7 rate (0-99) to coefficient
-        // Higher rate = faster envelope
-        for (int i = 0; i < 4; ++i) {
-            float rate = rates_[i];
-            // DX7-style rate scaling
-            float timeInSeconds = 10.0f * std::exp(-0.069f * rate);
-            coefficients_[i] = 1.0f - std::exp(-1.0f / (timeInSeconds * sampleRate_));
-        }
-    }
-
-    float sampleRate_ = 44100.0f;
-    float rates_[4] = {99.0f, 75.0f, 50.0f, 50.0f};
     float levels_[4] = {1.0f, 0.8f, 0.7f, 0.0f};
-    float coefficients_[4] = {0.01f, 0.001f, 0.001f, 0.001f};
+    EnvelopeCoefficients coefficients_ = {0.01f, 0.001f, 0.001f, 0.001f};
     float currentLevel_ = 0.0f;
     Stage stage_ = Stage::Idle;
 };
@@ -120,7 +116,6 @@ public:
     void setSampleRate(float sampleRate) {
         sampleRate_ = sampleRate;
         phaseIncrement_ = frequency_ / sampleRate_;
-        envelope_.setSampleRate(sampleRate);
     }
 
     void setFrequency(float frequency) {
@@ -128,33 +123,46 @@ public:
         phaseIncrement_ = frequency_ / sampleRate_;
     }
 
+    /// Ratio and detune changes retune a sounding note immediately
     void setRatio(float ratio) {
         ratio_ = ratio;
+        updateFrequency();
     }
 
     void setDetune(float detuneCents) {
-        detune_ = std::pow(2.0f, detuneCents / 1200.0f);
+        setDetuneFactor(std::pow(2.0f, detuneCents / 1200.0f));
+    }
+
+    /// Set detune as a frequency multiplier (precomputed from cents by the caller)
+    void setDetuneFactor(float factor) {
+        detune_ = factor;
+        updateFrequency();
     }
 
     void setLevel(float level) {
         level_ = level;
+        updateAmplitude();
     }
 
     void setFeedback(float feedback) {
         feedback_ = feedback;
     }
 
-    void setEnvelopeRates(float r1, float r2, float r3, float r4) {
-        envelope_.setRates(r1, r2, r3, r4);
-    }
-
     void setEnvelopeLevels(float l1, float l2, float l3, float l4) {
         envelope_.setLevels(l1, l2, l3, l4);
     }
 
-    void noteOn(float baseFrequency) {
-        frequency_ = baseFrequency * ratio_ * detune_;
-        phaseIncrement_ = frequency_ / sampleRate_;
+    void setEnvelopeCoefficients(const EnvelopeCoefficients& coefficients) {
+        envelope_.setCoefficients(coefficients);
+    }
+
+    /// @param baseFrequency Note frequency in Hz
+    /// @param noteGain Keyboard level scaling and velocity gain for this note
+    void noteOn(float baseFrequency, float noteGain = 1.0f) {
+        baseFrequency_ = baseFrequency;
+        noteGain_ = noteGain;
+        updateFrequency();
+        updateAmplitude();
         envelope_.noteOn();
         phase_ = 0.0f;
         previousOutput_ = 0.0f;
@@ -187,8 +195,8 @@ public:
         // Sine oscillator
         float output = std::sin(effectivePhase * 2.0f * M_PI);
 
-        // Apply envelope and level
-        output *= envelopeLevel * level_;
+        // Apply envelope, level and note scaling
+        output *= envelopeLevel * amplitude_;
 
         // Update phase
         phase_ += phaseIncrement_;
@@ -202,18 +210,46 @@ public:
         return output;
     }
 
+    /// Advance envelope and phase by one sample without rendering
+    /// Used for operators culled from the schedule: their output is silent
+    /// (zero level) or unused, so the oscillator and feedback are skipped.
+    void advance() {
+        envelope_.process();
+        phase_ += phaseIncrement_;
+        if (phase_ >= 1.0f) {
+            phase_ -= 1.0f;
+        }
+        previousOutput2_ = previousOutput_;
+        previousOutput_ = 0.0f;
+    }
+
     bool isActive() const { return envelope_.isActive(); }
 
     float getLevel() const { return level_; }
     float getRatio() const { return ratio_; }
     float getFeedback() const { return feedback_; }
+    const Envelope& getEnvelope() const { return envelope_; }
 
 private:
+    void updateFrequency() {
+        frequency_ = baseFrequency_ * ratio_ * detune_;
+        phaseIncrement_ = frequency_ / sampleRate_;
+    }
+
+    /// DX7 clamps the scaled output level at its maximum, so positive
+    /// keyboard/velocity scaling cannot push an operator past full level
+    void updateAmplitude() {
+        amplitude_ = std::min(level_ * noteGain_, DX7::kEnvelopeMaxLevel);
+    }
+
     float sampleRate_ = 44100.0f;
+    float baseFrequency_ = 440.0f;
     float frequency_ = 440.0f;
     float ratio_ = 1.0f;
     float detune_ = 1.0f;
     float level_ = 1.0f;
+    float noteGain_ = 1.0f;
+    float amplitude_ = 1.0f;
     float feedback_ = 0.0f;
     float phase_ = 0.0f;
     float phaseIncrement_ = 0.0f;
@@ -1,11 +1,19 @@
 #ifndef M2DXKernel_hpp
 #define M2DXKernel_hpp
 
+#include "CaptureRing.hpp"
+#include "DX7Algorithms.hpp"
 #include "DX7Constants.hpp"
+#include "EventTrace.hpp"
 #include "FMOperator.hpp"
+#include "OperatorScaling.hpp"
+#include "ParameterRamp.hpp"
 #include <array>
+#include <atomic>
 #include <cstdint>
 #include <algorithm>
+#include <initializer_list>
+#include <utility>
 
 namespace M2DX {
 
@@ -14,6 +22,12 @@ using DX7::kNumOperators;
 using DX7::kMaxVoices;
 using DX7::kNumAlgorithms;
 
+/// Frames per control-rate update while a parameter ramp is in progress
+constexpr int kRampBlockSize = 16;
+
+/// Maximum number of ramp events queued for a single render call
+constexpr int kMaxPendingRamps = 64;
+
 /// MIDI note with velocity
 struct MIDINote {
     uint8_t note = 0;
@@ -30,22 +44,26 @@ public:
         }
     }
 
-    void setAlgorithm(int algorithm) {
-        algorithm_ = std::clamp(algorithm, 0, kNumAlgorithms - 1);
+    /// Set the pruned operator schedule for the active patch (built by the kernel)
+    void setSchedule(const OperatorSchedule& schedule) {
+        schedule_ = schedule;
+        updateLiveOperators();
     }
 
-    void noteOn(uint8_t note, uint8_t velocity) {
+    /// Start a note using the kernel's precomputed tables (lookups only)
+    /// @param frequency Note frequency in Hz
+    /// @param scaling Per-operator keyboard/velocity scaling tables
+    void noteOn(uint8_t note, uint8_t velocity, float frequency,
+                const std::array<OperatorScaling, kNumOperators>& scaling) {
         note_.note = note;
         note_.velocity = velocity;
         note_.active = true;
 
-        float frequency = 440.0f * std::pow(2.0f, (note - 69) / 12.0f);
-        float velocityScale = velocity / 127.0f;
-
-        for (auto& op : operators_) {
-            op.noteOn(frequency);
+        for (int i = 0; i < kNumOperators; ++i) {
+            operators_[i].setEnvelopeCoefficients(scaling[i].getEnvelopeCoefficients(note));
+            operators_[i].noteOn(frequency, scaling[i].getNoteGain(note, velocity));
         }
-        velocityScale_ = velocityScale;
+        updateLiveOperators();
     }
 
     void noteOff() {
@@ -60,6 +78,8 @@ public:
         return processAlgorithm();
     }
 
+    /// A voice is active while any operator's envelope is running, scheduled or not,
+    /// so a released note frees its voice even while its carriers are culled
     bool isActive() const {
         for (const auto& op : operators_) {
             if (op.isActive()) return true;
@@ -68,173 +88,396 @@ public:
         return false;
     }
 
+    /// Drop operators whose envelope went idle, together with their upstream chains
+    /// Called once per block; an idle operator outputs silence until the next note-on,
+    /// so anything that only feeds it can be skipped as well. With no live carrier
+    /// the voice renders nothing and only advances its envelopes.
+    void updateLiveOperators() {
+        uint8_t live = 0;
+        uint8_t needed = 0;
+        for (int i = schedule_.numSteps - 1; i >= 0; --i) {
+            const OperatorRoute& route = schedule_.steps[i];
+            uint8_t bit = DX7::operatorBit(route.op);
+            if ((route.carrier || (needed & bit)) && operators_[route.op].isActive()) {
+                live |= bit;
+                needed |= route.modulators;
+            }
+        }
+        liveOperators_ = live;
+    }
+
     uint8_t getNote() const { return note_.note; }
 
     FMOperator& getOperator(int index) {
         return operators_[std::clamp(index, 0, kNumOperators - 1)];
     }
 
+    const FMOperator& getOperator(int index) const {
+        return operators_[std::clamp(index, 0, kNumOperators - 1)];
+    }
+
 private:
-    /// Process based on current algorithm
-    /// DX7 compatible: Algorithms 1-32 (6 operators)
-    /// Future: Algorithms 33-64 for 8-operator extended mode
+    /// Run the scheduled operators in routing order
+    /// DX7 compatible: Algorithms 1-32 (6 operators), see DX7Algorithms.hpp
+    ///
+    /// With nothing culled, the routing is unrolled at compile time so the
+    /// full patch costs no more than hand-written algorithm code.
     float processAlgorithm() {
-        float output = 0.0f;
-
-        // DX7 Algorithm implementations
-        // Currently implementing representative algorithms
-        // TODO: Implement all 32 DX7 algorithms
-        switch (algorithm_) {
-            case 0: // Algorithm 1: Serial chain OP6->5->4->3->2->1 (carriers: OP1)
-                output = processAlgorithm1();
-                break;
-
-            case 1: // Algorithm 2: OP6->5->4->3->2 + OP1 (carriers: OP1, OP2)
-                output = processAlgorithm2();
-                break;
-
-            case 4: // Algorithm 5: Parallel pairs
-                output = processAlgorithm5();
-                break;
-
-            case 31: // Algorithm 32: All parallel (carriers: all 6)
-                output = processAlgorithm32();
-                break;
-
-            default:
-                // Default to algorithm 1 for unimplemented
-                output = processAlgorithm1();
-                break;
+        if (schedule_.routing && liveOperators_ == DX7::kAllOperators) {
+            if (schedule_.routing == &DX7::kAlgorithm1) return processRouting<DX7::kAlgorithm1>();
+            if (schedule_.routing == &DX7::kAlgorithm2) return processRouting<DX7::kAlgorithm2>();
+            if (schedule_.routing == &DX7::kAlgorithm5) return processRouting<DX7::kAlgorithm5>();
+            if (schedule_.routing == &DX7::kAlgorithm32) return processRouting<DX7::kAlgorithm32>();
         }
-
-        return output * velocityScale_;
+        return processSchedule();
     }
 
-    // DX7 Algorithm 1: OP6->5->4->3->2->1 (serial)
-    float processAlgorithm1() {
-        float mod = operators_[5].process(); // OP6
-        mod = operators_[4].process(mod);    // OP5
-        mod = operators_[3].process(mod);    // OP4
-        mod = operators_[2].process(mod);    // OP3
-        mod = operators_[1].process(mod);    // OP2
-        return operators_[0].process(mod);   // OP1 (carrier)
+    /// Every operator of a routing, unrolled
+    template <const AlgorithmRouting& Routing>
+    float processRouting() {
+        std::array<float, kNumOperators> outputs{};
+        float output = 0.0f;
+        [&]<size_t... Step>(std::index_sequence<Step...>) {
+            (processRoute<Routing.routes[Step]>(outputs, output), ...);
+        }(std::make_index_sequence<kNumOperators>{});
+        return output * Routing.outputScale;
     }
 
-    // DX7 Algorithm 2: (OP6->5->4->3->2) + OP1
-    float processAlgorithm2() {
-        float mod = operators_[5].process(); // OP6
-        mod = operators_[4].process(mod);    // OP5
-        mod = operators_[3].process(mod);    // OP4
-        mod = operators_[2].process(mod);    // OP3
-        float out1 = operators_[1].process(mod);  // OP2 (carrier)
-        float out2 = operators_[0].process();     // OP1 (carrier)
-        return (out1 + out2) * 0.5f;
+    template <OperatorRoute Route>
+    void processRoute(std::array<float, kNumOperators>& outputs, float& output) {
+        float modulation = 0.0f;
+        uint8_t modulators = Route.modulators;
+        while (modulators != 0) {
+            modulation += outputs[__builtin_ctz(modulators)];
+            modulators &= modulators - 1;
+        }
+        outputs[Route.op] = operators_[Route.op].process(modulation);
+        if constexpr (Route.carrier) output += outputs[Route.op];
     }
 
-    // DX7 Algorithm 5: Parallel pairs (OP6->5, OP4->3, OP2->1)
-    float processAlgorithm5() {
-        float mod1 = operators_[5].process();     // OP6
-        float out1 = operators_[4].process(mod1); // OP5 (carrier)
+    /// Operators outside the schedule (zero level, or not reaching a carrier)
+    /// and operators dropped by updateLiveOperators() are not rendered; their
+    /// envelopes and phases still advance so releases finish on time.
+    float processSchedule() {
+        float output = 0.0f;
+        std::array<float, kNumOperators> outputs{};
 
-        float mod2 = operators_[3].process();     // OP4
-        float out2 = operators_[2].process(mod2); // OP3 (carrier)
+        for (int i = 0; i < schedule_.numSteps; ++i) {
+            const OperatorRoute& route = schedule_.steps[i];
+            if (!(liveOperators_ & DX7::operatorBit(route.op))) continue;
 
-        float mod3 = operators_[1].process();     // OP2
-        float out3 = operators_[0].process(mod3); // OP1 (carrier)
+            float modulation = 0.0f;
+            uint8_t modulators = route.modulators & liveOperators_;
+            while (modulators != 0) {
+                modulation += outputs[__builtin_ctz(modulators)];
+                modulators &= modulators - 1;
+            }
 
-        return (out1 + out2 + out3) * 0.33f;
-    }
+            float out = operators_[route.op].process(modulation);
+            outputs[route.op] = out;
+            if (route.carrier) output += out;
+        }
 
-    // DX7 Algorithm 32: All carriers parallel
-    float processAlgorithm32() {
-        float output = 0.0f;
-        for (int i = 0; i < kNumOperators; ++i) {
-            output += operators_[i].process();
+        uint8_t culled = static_cast<uint8_t>(~liveOperators_ & DX7::kAllOperators);
+        while (culled != 0) {
+            operators_[__builtin_ctz(culled)].advance();
+            culled &= culled - 1;
         }
-        return output / static_cast<float>(kNumOperators);
+
+        return output * schedule_.outputScale;
     }
 
     std::array<FMOperator, kNumOperators> operators_;
     mutable MIDINote note_;
-    int algorithm_ = 0;
-    float velocityScale_ = 1.0f;
+    OperatorSchedule schedule_ = DX7::buildOperatorSchedule(0, DX7::kAllOperators);
+    uint8_t liveOperators_ = 0;
 };
 
 /// Main DSP kernel with polyphonic voice management
+///
+/// Threading: all methods except postParameter(), postOperatorEnvelopeRates(),
+/// postOperatorEnvelopeLevels(), setCaptureRing() and setTraceRecorder() must
+/// be called from the render thread, or while no render call can run (e.g.
+/// before rendering starts). Other threads hand parameter changes over with
+/// the post methods.
 class M2DXKernel {
 public:
+    M2DXKernel() {
+        ramps_[kMasterVolumeRamp].reset(masterVolume_);
+        for (int i = 0; i < kNumOperators; ++i) {
+            ramps_[kOperatorLevelRamp + i].reset(1.0f);
+            ramps_[kOperatorRatioRamp + i].reset(1.0f);
+            ramps_[kOperatorDetuneRamp + i].reset(0.0f);
+        }
+        for (int note = 0; note < DX7::kNumMIDINotes; ++note) {
+            noteFrequencies_[note] = 440.0f * std::pow(2.0f, (note - 69) / 12.0f);
+        }
+    }
+
     void initialize(float sampleRate) {
+        trace(TraceEventType::SampleRate, {}, {sampleRate});
+        if (CaptureRing* ring = captureRing_.load(std::memory_order_acquire)) {
+            ring->markSampleRate(sampleRate);
+        }
         sampleRate_ = sampleRate;
         for (auto& voice : voices_) {
             voice.setSampleRate(sampleRate);
-            voice.setAlgorithm(algorithm_);
         }
+        rebuildSchedule();
+        for (int op = 0; op < kNumOperators; ++op) {
+            scaling_[op].setSampleRate(sampleRate);
+            applyEnvelopeCoefficients(op);
+        }
+        // Ramp durations are in frames and do not survive a rate change
+        finishRamps();
+        numPendingRamps_ = 0;
+    }
+
+    /// Change a parameter from any thread (AU parameter observer, UI)
+    /// @return false if the address cannot be posted
+    ///
+    /// Algorithm, master volume and operator level/ratio/detune/feedback/EG
+    /// rate/EG level are stored in per-parameter mailboxes and applied through
+    /// the immediate setter at the start of the next processBuffer(); the last
+    /// value posted wins.
+    bool postParameter(int address, float value) {
+        int stage = envelopeMailboxForAddress(address);
+        if (stage >= 0) {
+            postedEnvelopeValues_[stage].store(value, std::memory_order_relaxed);
+            postedEnvelopeMask_.fetch_or(uint64_t{1} << stage, std::memory_order_release);
+            return true;
+        }
+
+        int slot = mailboxForAddress(address);
+        if (slot < 0) return false;
+
+        postedValues_[slot].store(value, std::memory_order_relaxed);
+        postedMask_.fetch_or(1u << slot, std::memory_order_release);
+        return true;
+    }
+
+    /// Post all four EG rates of an operator from any thread
+    /// The stages are published together, so a render call never applies half of them.
+    void postOperatorEnvelopeRates(int opIndex, float r1, float r2, float r3, float r4) {
+        postEnvelopeStages(kEnvelopeRateMailbox, opIndex, {r1, r2, r3, r4});
+    }
+
+    /// Post all four EG levels of an operator from any thread
+    void postOperatorEnvelopeLevels(int opIndex, float l1, float l2, float l3, float l4) {
+        postEnvelopeStages(kEnvelopeLevelMailbox, opIndex, {l1, l2, l3, l4});
     }
 
     void setAlgorithm(int algorithm) {
+        trace(TraceEventType::Algorithm, {algorithm});
         algorithm_ = std::clamp(algorithm, 0, kNumAlgorithms - 1);
-        for (auto& voice : voices_) {
-            voice.setAlgorithm(algorithm_);
-        }
+        rebuildSchedule();
     }
 
     void setMasterVolume(float volume) {
+        trace(TraceEventType::MasterVolume, {}, {volume});
         masterVolume_ = std::clamp(volume, 0.0f, 1.0f);
+        stopRamp(kMasterVolumeRamp, masterVolume_);
     }
 
     /// Set operator parameter for all voices
+    /// Immediate setters cancel any ramp in progress on the same parameter.
     void setOperatorLevel(int opIndex, float level) {
-        for (auto& voice : voices_) {
-            voice.getOperator(opIndex).setLevel(level);
-        }
+        trace(TraceEventType::OperatorLevel, {opIndex}, {level});
+        opIndex = std::clamp(opIndex, 0, kNumOperators - 1);
+        stopRamp(kOperatorLevelRamp + opIndex, level);
+        applyOperatorLevel(opIndex, level);
     }
 
     void setOperatorRatio(int opIndex, float ratio) {
-        for (auto& voice : voices_) {
-            voice.getOperator(opIndex).setRatio(ratio);
-        }
+        trace(TraceEventType::OperatorRatio, {opIndex}, {ratio});
+        opIndex = std::clamp(opIndex, 0, kNumOperators - 1);
+        stopRamp(kOperatorRatioRamp + opIndex, ratio);
+        applyOperatorRatio(opIndex, ratio);
     }
 
     void setOperatorDetune(int opIndex, float detuneCents) {
-        for (auto& voice : voices_) {
-            voice.getOperator(opIndex).setDetune(detuneCents);
+        trace(TraceEventType::OperatorDetune, {opIndex}, {detuneCents});
+        opIndex = std::clamp(opIndex, 0, kNumOperators - 1);
+        stopRamp(kOperatorDetuneRamp + opIndex, detuneCents);
+        applyOperatorDetune(opIndex, detuneCents);
+    }
+
+    /// Schedule a sample-accurate parameter ramp (AU parameter ramp semantics)
+    /// @param address Parameter address (see DX7Constants.hpp)
+    /// @param target Value reached at the end of the ramp
+    /// @param frameOffset Frame within the next processBuffer call where the ramp starts
+    /// @param durationFrames Ramp length in frames (0 = step at frameOffset)
+    /// @param shape Interpolation curve
+    /// @return false if the address is not a rampable parameter
+    ///
+    /// Rampable parameters: master volume, operator level, ratio and detune.
+    /// Must be called from the render thread, before processBuffer().
+    /// Offsets beyond the buffer carry over into the following render call.
+    bool scheduleParameterRamp(int address, float target, int frameOffset,
+                               int durationFrames, RampShape shape = RampShape::Linear) {
+        trace(TraceEventType::ParameterRamp,
+              {address, frameOffset, durationFrames, static_cast<int32_t>(shape)}, {target});
+        int slot = rampSlotForAddress(address);
+        if (slot < 0) return false;
+
+        if (slot == kMasterVolumeRamp) {
+            target = std::clamp(target, 0.0f, 1.0f);
+        }
+
+        PendingRamp ramp{std::max(frameOffset, 0), std::max(durationFrames, 0), target, slot, shape};
+
+        // Queue full: start immediately rather than dropping the event
+        if (numPendingRamps_ >= kMaxPendingRamps) {
+            beginRamp(ramp);
+            return true;
+        }
+
+        // Keep the queue ordered by frame offset (stable for equal offsets)
+        int insertAt = numPendingRamps_;
+        while (insertAt > 0 && pendingRamps_[insertAt - 1].frameOffset > ramp.frameOffset) {
+            pendingRamps_[insertAt] = pendingRamps_[insertAt - 1];
+            --insertAt;
         }
+        pendingRamps_[insertAt] = ramp;
+        ++numPendingRamps_;
+        return true;
+    }
+
+    /// Resume a ramp segment captured by a trace snapshot (event trace replay)
+    /// @return false if the address is not a rampable parameter
+    bool restoreParameterRamp(int address, const ParameterRampState& state) {
+        trace(TraceEventType::RampState, {address, state.remainingFrames, state.exponential},
+              {state.current, state.target, state.step, state.logCurrent});
+        int slot = rampSlotForAddress(address);
+        if (slot < 0) return false;
+
+        ramps_[slot].restore(state);
+        if (ramps_[slot].isRamping()) {
+            activeRampMask_ |= 1u << slot;
+        } else {
+            activeRampMask_ &= ~(1u << slot);
+        }
+        return true;
+    }
+
+    /// Set a parameter by address through its immediate setter
+    /// Used for render-list parameter events on parameters that cannot be ramped.
+    /// EG rate/level addresses change one stage and keep the other three.
+    /// @return false if the address is unknown
+    bool setParameter(int address, float value) {
+        if (address == DX7::kAlgorithmAddress) {
+            setAlgorithm(static_cast<int>(value));
+            return true;
+        }
+        if (address == DX7::kMasterVolumeAddress) {
+            setMasterVolume(value);
+            return true;
+        }
+
+        int operatorEnd = DX7::kOperatorAddressBase + kNumOperators * DX7::kOperatorAddressStride;
+        if (address < DX7::kOperatorAddressBase || address >= operatorEnd) return false;
+
+        int opIndex = (address - DX7::kOperatorAddressBase) / DX7::kOperatorAddressStride;
+        int offset = (address - DX7::kOperatorAddressBase) % DX7::kOperatorAddressStride;
+        switch (offset) {
+            case DX7::kOperatorLevelOffset:    setOperatorLevel(opIndex, value);    return true;
+            case DX7::kOperatorRatioOffset:    setOperatorRatio(opIndex, value);    return true;
+            case DX7::kOperatorDetuneOffset:   setOperatorDetune(opIndex, value);   return true;
+            case DX7::kOperatorFeedbackOffset: setOperatorFeedback(opIndex, value); return true;
+            default: break;
+        }
+
+        int stage = offset - DX7::kOperatorEGRateOffset;
+        if (stage >= 0 && stage < DX7::kEnvelopeStages) {
+            auto rates = scaling_[opIndex].getEnvelopeRates();
+            rates[stage] = value;
+            setOperatorEnvelopeRates(opIndex, rates[0], rates[1], rates[2], rates[3]);
+            return true;
+        }
+
+        stage = offset - DX7::kOperatorEGLevelOffset;
+        if (stage >= 0 && stage < DX7::kEnvelopeStages) {
+            auto levels = getOperatorEnvelopeLevels(opIndex);
+            levels[stage] = value;
+            setOperatorEnvelopeLevels(opIndex, levels[0], levels[1], levels[2], levels[3]);
+            return true;
+        }
+        return false;
     }
 
     void setOperatorFeedback(int opIndex, float feedback) {
+        trace(TraceEventType::OperatorFeedback, {opIndex}, {feedback});
         for (auto& voice : voices_) {
             voice.getOperator(opIndex).setFeedback(feedback);
         }
     }
 
     void setOperatorEnvelopeRates(int opIndex, float r1, float r2, float r3, float r4) {
-        for (auto& voice : voices_) {
-            voice.getOperator(opIndex).setEnvelopeRates(r1, r2, r3, r4);
-        }
+        trace(TraceEventType::OperatorEnvelopeRates, {opIndex}, {r1, r2, r3, r4});
+        opIndex = std::clamp(opIndex, 0, kNumOperators - 1);
+        scaling_[opIndex].setEnvelopeRates(r1, r2, r3, r4);
+        applyEnvelopeCoefficients(opIndex);
     }
 
     void setOperatorEnvelopeLevels(int opIndex, float l1, float l2, float l3, float l4) {
+        trace(TraceEventType::OperatorEnvelopeLevels, {opIndex}, {l1, l2, l3, l4});
         for (auto& voice : voices_) {
             voice.getOperator(opIndex).setEnvelopeLevels(l1, l2, l3, l4);
         }
     }
 
+    /// Set keyboard level scaling (DX7 style)
+    /// @param breakPoint Break point (0-99, 0 = A-1, 39 = C3)
+    /// @param leftDepth Depth below the break point (0-99)
+    /// @param rightDepth Depth above the break point (0-99)
+    /// @param leftCurve Curve below the break point (0-3: -LIN, -EXP, +EXP, +LIN)
+    /// @param rightCurve Curve above the break point (0-3)
+    void setOperatorKeyboardLevelScaling(int opIndex, int breakPoint, int leftDepth, int rightDepth,
+                                         int leftCurve, int rightCurve) {
+        trace(TraceEventType::OperatorKeyboardLevelScaling,
+              {opIndex, breakPoint, leftDepth, rightDepth, leftCurve, rightCurve});
+        opIndex = std::clamp(opIndex, 0, kNumOperators - 1);
+        scaling_[opIndex].setKeyboardLevelScaling(
+            breakPoint, leftDepth, rightDepth,
+            static_cast<ScalingCurve>(std::clamp(leftCurve, 0, 3)),
+            static_cast<ScalingCurve>(std::clamp(rightCurve, 0, 3)));
+    }
+
+    /// Set keyboard rate scaling (0-7)
+    void setOperatorRateScaling(int opIndex, int rateScaling) {
+        trace(TraceEventType::OperatorRateScaling, {opIndex, rateScaling});
+        opIndex = std::clamp(opIndex, 0, kNumOperators - 1);
+        scaling_[opIndex].setRateScaling(rateScaling);
+        applyEnvelopeCoefficients(opIndex);
+    }
+
+    /// Set key velocity sensitivity (0-7)
+    void setOperatorVelocitySensitivity(int opIndex, int sensitivity) {
+        trace(TraceEventType::OperatorVelocitySensitivity, {opIndex, sensitivity});
+        opIndex = std::clamp(opIndex, 0, kNumOperators - 1);
+        scaling_[opIndex].setVelocitySensitivity(sensitivity);
+    }
+
     /// Handle MIDI note on
     void noteOn(uint8_t note, uint8_t velocity) {
         if (velocity == 0) {
             noteOff(note);
             return;
         }
+        trace(TraceEventType::NoteOn, {note, velocity});
 
         // Find free voice or steal oldest
         Voice* voice = findFreeVoice();
         if (voice) {
-            voice->noteOn(note, velocity);
+            voice->noteOn(note, velocity, noteFrequencies_[note & 0x7F], scaling_);
         }
     }
 
     /// Handle MIDI note off
+    /// Releases every sounding voice on the note, including voices whose
+    /// carriers are currently culled (e.g. level 0).
     void noteOff(uint8_t note) {
+        trace(TraceEventType::NoteOff, {note});
         for (auto& voice : voices_) {
             if (voice.isActive() && voice.getNote() == note) {
                 voice.noteOff();
@@ -244,6 +487,7 @@ public:
 
     /// All notes off
     void allNotesOff() {
+        trace(TraceEventType::AllNotesOff, {});
         for (auto& voice : voices_) {
             voice.noteOff();
         }
@@ -251,12 +495,531 @@ public:
 
     /// Process single sample (mono)
     /// @return Normalized output sample with master volume applied
+    float processSample() {
+        return mixVoices() * masterVolume_;
+    }
+
+    /// Process buffer (stereo interleaved)
+    ///
+    /// With no ramps queued or in progress this is a plain per-sample loop.
+    /// Otherwise the buffer is split at ramp start and end frames and every
+    /// kRampBlockSize frames. Ramped operator values are pushed to the voices
+    /// once per segment, taking the value at the segment midpoint; master
+    /// volume is interpolated per sample.
+    void processBuffer(float* outputL, float* outputR, int numFrames) {
+        applyPostedParameters();
+
+        // Block events carry the frame position at the start of the block
+        trace(TraceEventType::Block, {numFrames});
+        framePosition_.fetch_add(static_cast<uint64_t>(std::max(numFrames, 0)),
+                                 std::memory_order_relaxed);
+
+        // Operator culling is refreshed at block granularity
+        if (!publishSchedule()) {
+            for (auto& voice : voices_) {
+                voice.updateLiveOperators();
+            }
+        }
+
+        if (activeRampMask_ == 0 && numPendingRamps_ == 0) {
+            for (int i = 0; i < numFrames; ++i) {
+                float sample = processSample();
+                outputL[i] = sample;
+                outputR[i] = sample;
+            }
+            finishBlock(outputL, outputR, numFrames);
+            return;
+        }
+
+        int frame = 0;
+        int nextRamp = 0;
+        while (frame < numFrames) {
+            while (nextRamp < numPendingRamps_ && pendingRamps_[nextRamp].frameOffset <= frame) {
+                beginRamp(pendingRamps_[nextRamp++]);
+            }
+
+            int segmentEnd = std::min(numFrames, frame + kRampBlockSize);
+            if (nextRamp < numPendingRamps_) {
+                segmentEnd = std::min(segmentEnd, pendingRamps_[nextRamp].frameOffset);
+            }
+            // Ramps end exactly on their last frame
+            segmentEnd = std::min(segmentEnd, frame + framesToFirstRampEnd());
+            int segmentFrames = segmentEnd - frame;
+
+            float volumeStart = masterVolume_;
+            advanceMasterVolumeRamp(segmentFrames);
+            float volumeStep = (masterVolume_ - volumeStart) / static_cast<float>(segmentFrames);
+
+            int midpoint = segmentFrames / 2;
+            advanceOperatorRamps(midpoint, true);
+            // A ramp leaving or reaching level 0 reschedules before the segment renders
+            publishSchedule();
+
+            for (int i = frame; i < segmentEnd; ++i) {
+                volumeStart += volumeStep;
+                float sample = mixVoices() * volumeStart;
+                outputL[i] = sample;
+                outputR[i] = sample;
+            }
+
+            // Values for the next segment are pushed at its own midpoint;
+            // only ramps that end here need their target applied now
+            advanceOperatorRamps(segmentFrames - midpoint, false);
+            frame = segmentEnd;
+        }
+
+        // Carry events scheduled past the end of this buffer into the next one
+        int remaining = 0;
+        for (int i = nextRamp; i < numPendingRamps_; ++i) {
+            pendingRamps_[remaining] = pendingRamps_[i];
+            pendingRamps_[remaining].frameOffset -= numFrames;
+            ++remaining;
+        }
+        numPendingRamps_ = remaining;
+
+        finishBlock(outputL, outputR, numFrames);
+    }
+
+    /// Attach an output capture tap (nullptr detaches)
+    /// Every rendered block is copied into the ring; the ring must outlive
+    /// any render call that may still observe it after detaching.
+    void setCaptureRing(CaptureRing* ring) {
+        captureRing_.store(ring, std::memory_order_release);
+    }
+
+    int getActiveVoiceCount() const {
+        int count = 0;
+        for (const auto& voice : voices_) {
+            if (voice.isActive()) ++count;
+        }
+        return count;
+    }
+
+    /// Attach an event trace recorder (nullptr detaches); callable from any thread
+    ///
+    /// The render thread picks the recorder up at the end of its next
+    /// processBuffer() call, records a snapshot of the current parameters there
+    /// (values mid-ramp, ramps in progress and queued ramps) so a replay starts
+    /// from the same state, and then records every kernel call with the kernel
+    /// frame position, plus a Block event per processBuffer() call. Recording
+    /// therefore starts with a whole render call. The previous recorder stops
+    /// receiving events as soon as the change is posted. Notes already sounding
+    /// are not captured.
+    /// The recorder must outlive any call that may still observe it after detaching.
+    void setTraceRecorder(TraceRecorder* recorder) {
+        pendingTraceRecorder_.store(recorder, std::memory_order_relaxed);
+        traceRecorderChanged_.store(true, std::memory_order_release);
+    }
+
+    /// True while any parameter ramp is queued or in progress
+    bool isRamping() const {
+        return activeRampMask_ != 0 || numPendingRamps_ > 0;
+    }
+
+private:
+    /// Ramp slot layout: master volume, then per-operator level, ratio, detune
+    static constexpr int kMasterVolumeRamp = 0;
+    static constexpr int kOperatorLevelRamp = 1;
+    static constexpr int kOperatorRatioRamp = kOperatorLevelRamp + kNumOperators;
+    static constexpr int kOperatorDetuneRamp = kOperatorRatioRamp + kNumOperators;
+    static constexpr int kNumRampSlots = kOperatorDetuneRamp + kNumOperators;
+    static_assert(kNumRampSlots <= 32, "activeRampMask_ holds one bit per ramp slot");
+
+    /// postParameter() mailboxes: one per ramp slot, then the algorithm and
+    /// per-operator feedback
+    static constexpr int kAlgorithmMailbox = kNumRampSlots;
+    static constexpr int kFeedbackMailbox = kAlgorithmMailbox + 1;
+    static constexpr int kNumMailboxes = kFeedbackMailbox + kNumOperators;
+    static_assert(kNumMailboxes <= 32, "postedMask_ holds one bit per mailbox");
+
+    /// EG mailboxes: one per operator and stage, rates then levels
+    static constexpr int kEnvelopeRateMailbox = 0;
+    static constexpr int kEnvelopeLevelMailbox = kNumOperators * DX7::kEnvelopeStages;
+    static constexpr int kNumEnvelopeMailboxes = 2 * kEnvelopeLevelMailbox;
+    static_assert(kNumEnvelopeMailboxes <= 64, "postedEnvelopeMask_ holds one bit per mailbox");
+
+    struct PendingRamp {
+        int frameOffset;
+        int durationFrames;
+        float target;
+        int slot;
+        RampShape shape;
+    };
+
+    static int rampSlotForAddress(int address) {
+        if (address == DX7::kMasterVolumeAddress) return kMasterVolumeRamp;
+
+        int operatorEnd = DX7::kOperatorAddressBase + kNumOperators * DX7::kOperatorAddressStride;
+        if (address < DX7::kOperatorAddressBase || address >= operatorEnd) return -1;
+
+        int opIndex = (address - DX7::kOperatorAddressBase) / DX7::kOperatorAddressStride;
+        switch ((address - DX7::kOperatorAddressBase) % DX7::kOperatorAddressStride) {
+            case DX7::kOperatorLevelOffset:  return kOperatorLevelRamp + opIndex;
+            case DX7::kOperatorRatioOffset:  return kOperatorRatioRamp + opIndex;
+            case DX7::kOperatorDetuneOffset: return kOperatorDetuneRamp + opIndex;
+            default:                         return -1;
+        }
+    }
+
+    static int addressForRampSlot(int slot) {
+        if (slot == kMasterVolumeRamp) return DX7::kMasterVolumeAddress;
+        if (slot < kOperatorRatioRamp) return DX7::getOperatorLevelAddress(slot - kOperatorLevelRamp);
+        if (slot < kOperatorDetuneRamp) return DX7::getOperatorRatioAddress(slot - kOperatorRatioRamp);
+        return DX7::getOperatorDetuneAddress(slot - kOperatorDetuneRamp);
+    }
+
+    static int mailboxForAddress(int address) {
+        if (address == DX7::kAlgorithmAddress) return kAlgorithmMailbox;
+
+        int operatorEnd = DX7::kOperatorAddressBase + kNumOperators * DX7::kOperatorAddressStride;
+        if (address >= DX7::kOperatorAddressBase && address < operatorEnd &&
+            (address - DX7::kOperatorAddressBase) % DX7::kOperatorAddressStride == DX7::kOperatorFeedbackOffset) {
+            return kFeedbackMailbox + (address - DX7::kOperatorAddressBase) / DX7::kOperatorAddressStride;
+        }
+        return rampSlotForAddress(address);
+    }
+
+    static int envelopeMailboxForAddress(int address) {
+        int operatorEnd = DX7::kOperatorAddressBase + kNumOperators * DX7::kOperatorAddressStride;
+        if (address < DX7::kOperatorAddressBase || address >= operatorEnd) return -1;
+
+        int opIndex = (address - DX7::kOperatorAddressBase) / DX7::kOperatorAddressStride;
+        int offset = (address - DX7::kOperatorAddressBase) % DX7::kOperatorAddressStride;
+        int stage = offset - DX7::kOperatorEGRateOffset;
+        if (stage >= 0 && stage < DX7::kEnvelopeStages) {
+            return kEnvelopeRateMailbox + opIndex * DX7::kEnvelopeStages + stage;
+        }
+        stage = offset - DX7::kOperatorEGLevelOffset;
+        if (stage >= 0 && stage < DX7::kEnvelopeStages) {
+            return kEnvelopeLevelMailbox + opIndex * DX7::kEnvelopeStages + stage;
+        }
+        return -1;
+    }
+
+    void postEnvelopeStages(int base, int opIndex, const std::array<float, DX7::kEnvelopeStages>& values) {
+        if (opIndex < 0 || opIndex >= kNumOperators) return;
+        int first = base + opIndex * DX7::kEnvelopeStages;
+        for (int stage = 0; stage < DX7::kEnvelopeStages; ++stage) {
+            postedEnvelopeValues_[first + stage].store(values[stage], std::memory_order_relaxed);
+        }
+        constexpr uint64_t kStageBits = (uint64_t{1} << DX7::kEnvelopeStages) - 1;
+        postedEnvelopeMask_.fetch_or(kStageBits << first, std::memory_order_release);
+    }
+
+    std::array<float, DX7::kEnvelopeStages> getOperatorEnvelopeLevels(int opIndex) const {
+        const Envelope& envelope = voices_[0].getOperator(opIndex).getEnvelope();
+        return {envelope.getLevel(0), envelope.getLevel(1), envelope.getLevel(2), envelope.getLevel(3)};
+    }
+
+    /// Apply values posted from other threads (render thread)
+    void applyPostedParameters() {
+        if (postedEnvelopeMask_.load(std::memory_order_relaxed) != 0) {
+            applyPostedEnvelopes();
+        }
+        if (postedMask_.load(std::memory_order_relaxed) == 0) return;
+
+        uint32_t mask = postedMask_.exchange(0, std::memory_order_acquire);
+        while (mask != 0) {
+            int slot = __builtin_ctz(mask);
+            mask &= mask - 1;
+
+            float value = postedValues_[slot].load(std::memory_order_relaxed);
+            if (slot == kAlgorithmMailbox) {
+                setAlgorithm(static_cast<int>(value));
+            } else if (slot >= kFeedbackMailbox) {
+                setOperatorFeedback(slot - kFeedbackMailbox, value);
+            } else if (slot == kMasterVolumeRamp) {
+                setMasterVolume(value);
+            } else if (slot < kOperatorRatioRamp) {
+                setOperatorLevel(slot - kOperatorLevelRamp, value);
+            } else if (slot < kOperatorDetuneRamp) {
+                setOperatorRatio(slot - kOperatorRatioRamp, value);
+            } else {
+                setOperatorDetune(slot - kOperatorDetuneRamp, value);
+            }
+        }
+    }
+
+    /// Posted EG stages are merged per operator so each operator rebuilds its
+    /// rate table once, however many stages changed
+    void applyPostedEnvelopes() {
+        uint64_t mask = postedEnvelopeMask_.exchange(0, std::memory_order_acquire);
+        for (int op = 0; op < kNumOperators; ++op) {
+            int first = op * DX7::kEnvelopeStages;
+            auto rateBits = static_cast<unsigned>(mask >> (kEnvelopeRateMailbox + first)) & 0xF;
+            auto levelBits = static_cast<unsigned>(mask >> (kEnvelopeLevelMailbox + first)) & 0xF;
+
+            if (rateBits != 0) {
+                auto rates = scaling_[op].getEnvelopeRates();
+                for (int stage = 0; stage < DX7::kEnvelopeStages; ++stage) {
+                    if (rateBits & (1u << stage)) {
+                        rates[stage] = postedEnvelopeValues_[kEnvelopeRateMailbox + first + stage]
+                                           .load(std::memory_order_relaxed);
+                    }
+                }
+                setOperatorEnvelopeRates(op, rates[0], rates[1], rates[2], rates[3]);
+            }
+            if (levelBits != 0) {
+                auto levels = getOperatorEnvelopeLevels(op);
+                for (int stage = 0; stage < DX7::kEnvelopeStages; ++stage) {
+                    if (levelBits & (1u << stage)) {
+                        levels[stage] = postedEnvelopeValues_[kEnvelopeLevelMailbox + first + stage]
+                                            .load(std::memory_order_relaxed);
+                    }
+                }
+                setOperatorEnvelopeLevels(op, levels[0], levels[1], levels[2], levels[3]);
+            }
+        }
+    }
+
+    void beginRamp(const PendingRamp& ramp) {
+        ParameterRamp& state = ramps_[ramp.slot];
+        state.start(ramp.target, ramp.durationFrames, ramp.shape);
+        if (state.isRamping()) {
+            activeRampMask_ |= 1u << ramp.slot;
+        } else {
+            activeRampMask_ &= ~(1u << ramp.slot);
+            applyRampValue(ramp.slot, state.getValue());
+        }
+    }
+
+    /// Render thread only: traceRecorder_ is never touched from other threads
+    void trace(TraceEventType type, std::initializer_list<int32_t> ints,
+               std::initializer_list<float> values = {}) {
+        if (traceRecorder_ && !traceRecorderChanged_.load(std::memory_order_relaxed)) {
+            traceRecorder_->record(makeTraceEvent(type, ints, values));
+        }
+    }
+
+    /// Render thread, end of processBuffer(): switch to the recorder set by setTraceRecorder()
+    void attachPendingTraceRecorder() {
+        if (!traceRecorderChanged_.exchange(false, std::memory_order_acquire)) return;
+
+        traceRecorder_ = pendingTraceRecorder_.load(std::memory_order_relaxed);
+        if (traceRecorder_) {
+            framePosition_.store(0, std::memory_order_relaxed);
+            recordSnapshot(*traceRecorder_);
+        }
+    }
+
+    TraceEvent makeTraceEvent(TraceEventType type, std::initializer_list<int32_t> ints,
+                              std::initializer_list<float> values = {}) const {
+        TraceEvent event;
+        event.frame = framePosition_.load(std::memory_order_relaxed);
+        event.type = type;
+        std::copy(ints.begin(), ints.end(), event.ints.begin());
+        std::copy(values.begin(), values.end(), event.values.begin());
+        return event;
+    }
+
+    /// Record the current patch as a sequence of setter events
+    ///
+    /// Rampable parameters are recorded at their current value; ramps in
+    /// progress follow as RampState events and queued ramps as ParameterRamp
+    /// events, so a replay continues the automation bit for bit.
+    void recordSnapshot(TraceRecorder& recorder) const {
+        recorder.record(makeTraceEvent(TraceEventType::SampleRate, {}, {sampleRate_}));
+        recorder.record(makeTraceEvent(TraceEventType::Algorithm, {algorithm_}));
+        recorder.record(makeTraceEvent(TraceEventType::MasterVolume, {},
+                                       {ramps_[kMasterVolumeRamp].getValue()}));
+
+        for (int op = 0; op < kNumOperators; ++op) {
+            const FMOperator& voiceOperator = voices_[0].getOperator(op);
+            const Envelope& envelope = voiceOperator.getEnvelope();
+            const OperatorScaling& scaling = scaling_[op];
+            const auto& rates = scaling.getEnvelopeRates();
+
+            recorder.record(makeTraceEvent(TraceEventType::OperatorLevel, {op},
+                                           {ramps_[kOperatorLevelRamp + op].getValue()}));
+            recorder.record(makeTraceEvent(TraceEventType::OperatorRatio, {op},
+                                           {ramps_[kOperatorRatioRamp + op].getValue()}));
+            recorder.record(makeTraceEvent(TraceEventType::OperatorDetune, {op},
+                                           {ramps_[kOperatorDetuneRamp + op].getValue()}));
+            recorder.record(makeTraceEvent(TraceEventType::OperatorFeedback, {op},
+                                           {voiceOperator.getFeedback()}));
+            recorder.record(makeTraceEvent(TraceEventType::OperatorEnvelopeRates, {op},
+                                           {rates[0], rates[1], rates[2], rates[3]}));
+            recorder.record(makeTraceEvent(TraceEventType::OperatorEnvelopeLevels, {op},
+                                           {envelope.getLevel(0), envelope.getLevel(1),
+                                            envelope.getLevel(2), envelope.getLevel(3)}));
+            recorder.record(makeTraceEvent(TraceEventType::OperatorKeyboardLevelScaling,
+                                           {op, scaling.getBreakPoint(), scaling.getLeftDepth(),
+                                            scaling.getRightDepth(),
+                                            static_cast<int32_t>(scaling.getLeftCurve()),
+                                            static_cast<int32_t>(scaling.getRightCurve())}));
+            recorder.record(makeTraceEvent(TraceEventType::OperatorRateScaling,
+                                           {op, scaling.getRateScaling()}));
+            recorder.record(makeTraceEvent(TraceEventType::OperatorVelocitySensitivity,
+                                           {op, scaling.getVelocitySensitivity()}));
+        }
+
+        uint32_t mask = activeRampMask_;
+        while (mask != 0) {
+            int slot = __builtin_ctz(mask);
+            mask &= mask - 1;
+
+            ParameterRampState state = ramps_[slot].getState();
+            recorder.record(makeTraceEvent(TraceEventType::RampState,
+                                           {addressForRampSlot(slot), state.remainingFrames, state.exponential},
+                                           {state.current, state.target, state.step, state.logCurrent}));
+        }
+        for (int i = 0; i < numPendingRamps_; ++i) {
+            const PendingRamp& ramp = pendingRamps_[i];
+            recorder.record(makeTraceEvent(TraceEventType::ParameterRamp,
+                                           {addressForRampSlot(ramp.slot), ramp.frameOffset,
+                                            ramp.durationFrames, static_cast<int32_t>(ramp.shape)},
+                                           {ramp.target}));
+        }
+    }
+
+    void captureBlock(const float* outputL, const float* outputR, int numFrames) {
+        if (CaptureRing* ring = captureRing_.load(std::memory_order_acquire)) {
+            ring->write(outputL, outputR, numFrames);
+        }
+    }
+
+    void finishBlock(const float* outputL, const float* outputR, int numFrames) {
+        captureBlock(outputL, outputR, numFrames);
+        if (traceRecorderChanged_.load(std::memory_order_relaxed)) {
+            attachPendingTraceRecorder();
+        }
+    }
+
+    void stopRamp(int slot, float value) {
+        ramps_[slot].reset(value);
+        activeRampMask_ &= ~(1u << slot);
+    }
+
+    /// Frames until the first moving ramp reaches its target
+    int framesToFirstRampEnd() const {
+        int frames = kRampBlockSize;
+        uint32_t mask = activeRampMask_;
+        while (mask != 0) {
+            int slot = __builtin_ctz(mask);
+            mask &= mask - 1;
+            frames = std::min(frames, ramps_[slot].getRemainingFrames());
+        }
+        return frames;
+    }
+
+    /// Advance the master volume ramp to the end of a segment
+    void advanceMasterVolumeRamp(int frames) {
+        constexpr uint32_t bit = 1u << kMasterVolumeRamp;
+        if (!(activeRampMask_ & bit)) return;
+
+        ParameterRamp& ramp = ramps_[kMasterVolumeRamp];
+        masterVolume_ = ramp.advance(frames);
+        if (!ramp.isRamping()) {
+            activeRampMask_ &= ~bit;
+        }
+    }
+
+    /// Advance every moving operator ramp
+    /// @param pushValues Push the new values to the voices; otherwise only
+    ///                   ramps that reached their target are pushed
+    void advanceOperatorRamps(int frames, bool pushValues) {
+        uint32_t mask = activeRampMask_ & ~(1u << kMasterVolumeRamp);
+        while (mask != 0) {
+            int slot = __builtin_ctz(mask);
+            mask &= mask - 1;
+
+            ParameterRamp& ramp = ramps_[slot];
+            float value = ramp.advance(frames);
+            bool finished = !ramp.isRamping();
+            if (pushValues || finished) {
+                applyRampValue(slot, value);
+            }
+            if (finished) {
+                activeRampMask_ &= ~(1u << slot);
+            }
+        }
+    }
+
+    /// Jump all ramps to their targets
+    void finishRamps() {
+        for (int slot = 0; slot < kNumRampSlots; ++slot) {
+            if (ramps_[slot].isRamping()) {
+                float target = ramps_[slot].getTarget();
+                ramps_[slot].reset(target);
+                applyRampValue(slot, target);
+            }
+        }
+        activeRampMask_ = 0;
+    }
+
+    void applyRampValue(int slot, float value) {
+        if (slot == kMasterVolumeRamp) {
+            masterVolume_ = value;
+        } else if (slot < kOperatorRatioRamp) {
+            applyOperatorLevel(slot - kOperatorLevelRamp, value);
+        } else if (slot < kOperatorDetuneRamp) {
+            applyOperatorRatio(slot - kOperatorRatioRamp, value);
+        } else {
+            applyOperatorDetune(slot - kOperatorDetuneRamp, value);
+        }
+    }
+
+    /// Push rate-scaled envelope coefficients to every voice for its current note
+    void applyEnvelopeCoefficients(int opIndex) {
+        for (auto& voice : voices_) {
+            voice.getOperator(opIndex).setEnvelopeCoefficients(
+                scaling_[opIndex].getEnvelopeCoefficients(voice.getNote()));
+        }
+    }
+
+    void applyOperatorLevel(int opIndex, float level) {
+        for (auto& voice : voices_) {
+            voice.getOperator(opIndex).setLevel(level);
+        }
+
+        // Reschedule only when the operator starts or stops contributing
+        uint8_t bit = DX7::operatorBit(opIndex);
+        uint8_t audible = level > 0.0f ? (audibleOperators_ | bit) : (audibleOperators_ & ~bit);
+        if (audible != audibleOperators_) {
+            audibleOperators_ = audible;
+            rebuildSchedule();
+        }
+    }
+
+    /// Prune the current algorithm against operator levels
+    /// The voices pick it up at the next block or ramp segment (publishSchedule()),
+    /// so several changes in one event batch cost a single voice update.
+    void rebuildSchedule() {
+        schedule_ = DX7::buildOperatorSchedule(algorithm_, audibleOperators_);
+        scheduleChanged_.store(true, std::memory_order_release);
+    }
+
+    /// Render thread: hand a rebuilt schedule to every voice
+    /// @return true if the voices were updated (which also refreshes their live operators)
+    bool publishSchedule() {
+        if (!scheduleChanged_.exchange(false, std::memory_order_acquire)) return false;
+        for (auto& voice : voices_) {
+            voice.setSchedule(schedule_);
+        }
+        return true;
+    }
+
+    void applyOperatorRatio(int opIndex, float ratio) {
+        for (auto& voice : voices_) {
+            voice.getOperator(opIndex).setRatio(ratio);
+        }
+    }
+
+    void applyOperatorDetune(int opIndex, float detuneCents) {
+        // One pow() per update, shared by all voices
+        float factor = std::pow(2.0f, detuneCents / 1200.0f);
+        for (auto& voice : voices_) {
+            voice.getOperator(opIndex).setDetuneFactor(factor);
+        }
+    }
+
+    /// Sum all active voices with normalization (master volume not applied)
     ///
     /// Voice normalization:
     /// Uses sqrt(N) * 0.7 scaling to balance headroom and prevent clipping.
     /// The 0.7 factor compensates for typical voice stacking behavior,
     /// providing better perceived loudness without excessive level reduction.
-    float processSample() {
+    float mixVoices() {
         float output = 0.0f;
         int activeVoices = 0;
 
@@ -274,27 +1037,9 @@ public:
             output /= normalization;
         }
 
-        return output * masterVolume_;
+        return output;
     }
 
-    /// Process buffer (stereo interleaved)
-    void processBuffer(float* outputL, float* outputR, int numFrames) {
-        for (int i = 0; i < numFrames; ++i) {
-            float sample = processSample();
-            outputL[i] = sample;
-            outputR[i] = sample;
-        }
-    }
-
-    int getActiveVoiceCount() const {
-        int count = 0;
-        for (const auto& voice : voices_) {
-            if (voice.isActive()) ++count;
-        }
-        return count;
-    }
-
-private:
     Voice* findFreeVoice() {
         // First, find an inactive voice
         for (auto& voice : voices_) {
@@ -311,6 +1056,28 @@ private:
     float sampleRate_ = 44100.0f;
     float masterVolume_ = 0.7f;
     int algorithm_ = 0;
+    uint8_t audibleOperators_ = DX7::kAllOperators;
+    OperatorSchedule schedule_ = DX7::buildOperatorSchedule(0, DX7::kAllOperators);
+    std::atomic<bool> scheduleChanged_{false};
+
+    std::array<OperatorScaling, kNumOperators> scaling_;
+    std::array<float, DX7::kNumMIDINotes> noteFrequencies_{};
+
+    std::array<ParameterRamp, kNumRampSlots> ramps_;
+    uint32_t activeRampMask_ = 0;
+    std::array<PendingRamp, kMaxPendingRamps> pendingRamps_{};
+    int numPendingRamps_ = 0;
+
+    std::array<std::atomic<float>, kNumMailboxes> postedValues_{};
+    std::atomic<uint32_t> postedMask_{0};
+    std::array<std::atomic<float>, kNumEnvelopeMailboxes> postedEnvelopeValues_{};
+    std::atomic<uint64_t> postedEnvelopeMask_{0};
+
+    std::atomic<CaptureRing*> captureRing_{nullptr};
+    TraceRecorder* traceRecorder_ = nullptr;  // Render thread
+    std::atomic<TraceRecorder*> pendingTraceRecorder_{nullptr};
+    std::atomic<bool> traceRecorderChanged_{false};
+    std::atomic<uint64_t> framePosition_{0};
 };
 
 } // namespace M2DX
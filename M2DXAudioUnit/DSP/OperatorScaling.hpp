@@ -0,0 +1,177 @@
+#ifndef OperatorScaling_hpp
+#define OperatorScaling_hpp
+
+#include "DX7Constants.hpp"
+#include "FMOperator.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+namespace M2DX {
+
+/// DX7 keyboard level scaling curve (same order as the DX7 voice data)
+enum class ScalingCurve : uint8_t {
+    NegativeLinear = 0,
+    NegativeExponential = 1,
+    PositiveExponential = 2,
+    PositiveLinear = 3
+};
+
+/// Per-operator keyboard level scaling, keyboard rate scaling and velocity sensitivity
+///
+/// All curve math happens in the setters (patch load) and fills lookup tables.
+/// Note-on only reads getNoteGain() and getEnvelopeCoefficients().
+/// Scaling math follows the DX7 / Dexed integer formulas.
+class OperatorScaling {
+public:
+    OperatorScaling() {
+        rebuildLevelTable();
+        rebuildVelocityTable();
+        rebuildRateTable();
+    }
+
+    /// Set keyboard level scaling
+    /// @param breakPoint Break point (0-99, 0 = A-1, 39 = C3)
+    /// @param leftDepth Depth below the break point (0-99)
+    /// @param rightDepth Depth above the break point (0-99)
+    /// @param leftCurve Curve below the break point
+    /// @param rightCurve Curve above the break point
+    void setKeyboardLevelScaling(int breakPoint, int leftDepth, int rightDepth,
+                                 ScalingCurve leftCurve, ScalingCurve rightCurve) {
+        breakPoint_ = std::clamp(breakPoint, 0, DX7::kMaxKeyboardScalingBreakPoint);
+        leftDepth_ = std::clamp(leftDepth, 0, DX7::kMaxKeyboardScalingDepth);
+        rightDepth_ = std::clamp(rightDepth, 0, DX7::kMaxKeyboardScalingDepth);
+        leftCurve_ = leftCurve;
+        rightCurve_ = rightCurve;
+        rebuildLevelTable();
+    }
+
+    /// Set key velocity sensitivity (0-7, 0 = velocity ignored)
+    void setVelocitySensitivity(int sensitivity) {
+        velocitySensitivity_ = std::clamp(sensitivity, 0, DX7::kMaxVelocitySensitivity);
+        rebuildVelocityTable();
+    }
+
+    /// Set keyboard rate scaling (0-7, 0 = same envelope speed on every key)
+    void setRateScaling(int rateScaling) {
+        rateScaling_ = std::clamp(rateScaling, 0, DX7::kMaxRateScaling);
+        rebuildRateTable();
+    }
+
+    /// Set envelope rates (DX7 style 0-99) used for the coefficient table
+    void setEnvelopeRates(float r1, float r2, float r3, float r4) {
+        rates_ = {r1, r2, r3, r4};
+        rebuildRateTable();
+    }
+
+    void setSampleRate(float sampleRate) {
+        sampleRate_ = sampleRate;
+        rebuildRateTable();
+    }
+
+    /// Combined keyboard level scaling and velocity gain (linear)
+    float getNoteGain(uint8_t note, uint8_t velocity) const {
+        return levelGain_[note & 0x7F] * velocityGain_[velocity & 0x7F];
+    }
+
+    /// Envelope coefficients with keyboard rate scaling applied
+    const EnvelopeCoefficients& getEnvelopeCoefficients(uint8_t note) const {
+        return rateCoefficients_[rateScalingGroup(note & 0x7F)];
+    }
+
+    const std::array<float, DX7::kEnvelopeStages>& getEnvelopeRates() const { return rates_; }
+    int getBreakPoint() const { return breakPoint_; }
+    int getLeftDepth() const { return leftDepth_; }
+    int getRightDepth() const { return rightDepth_; }
+    ScalingCurve getLeftCurve() const { return leftCurve_; }
+    ScalingCurve getRightCurve() const { return rightCurve_; }
+    int getRateScaling() const { return rateScaling_; }
+    int getVelocitySensitivity() const { return velocitySensitivity_; }
+
+private:
+    static float levelStepsToGain(float steps) {
+        return std::pow(10.0f, steps * DX7::kOutputLevelStepDB / 20.0f);
+    }
+
+    /// Dexed ScaleCurve(): level offset in output level steps
+    static int scaleCurve(int group, int depth, ScalingCurve curve) {
+        static constexpr int kExpScaleData[] = {
+            0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 11, 14, 16, 19, 23, 27, 33,
+            39, 47, 56, 66, 80, 94, 110, 126, 142, 158, 174, 190, 206, 222, 238, 250
+        };
+        constexpr int kExpScaleSize = sizeof(kExpScaleData) / sizeof(kExpScaleData[0]);
+
+        int scale;
+        if (curve == ScalingCurve::NegativeLinear || curve == ScalingCurve::PositiveLinear) {
+            scale = (group * depth * 329) >> 12;
+        } else {
+            int rawExp = kExpScaleData[std::min(group, kExpScaleSize - 1)];
+            scale = (rawExp * depth * 329) >> 15;
+        }
+        if (curve == ScalingCurve::NegativeLinear || curve == ScalingCurve::NegativeExponential) {
+            scale = -scale;
+        }
+        return scale;
+    }
+
+    /// Notes are grouped by 3 semitones starting at C1 (Dexed ScaleRate())
+    static int rateScalingGroup(int note) {
+        return std::clamp(note / 3 - 7, 0, DX7::kRateScalingGroups - 1);
+    }
+
+    void rebuildLevelTable() {
+        for (int note = 0; note < DX7::kNumMIDINotes; ++note) {
+            int offset = note - breakPoint_ - 17;
+            int steps = offset >= 0
+                ? scaleCurve((offset + 1) / 3, rightDepth_, rightCurve_)
+                : scaleCurve(-(offset - 1) / 3, leftDepth_, leftCurve_);
+            levelGain_[note] = levelStepsToGain(static_cast<float>(steps));
+        }
+    }
+
+    /// Dexed ScaleVelocity(): offset in 1/32 output level steps
+    void rebuildVelocityTable() {
+        static constexpr int kVelocityData[64] = {
+            0, 70, 86, 97, 106, 114, 121, 126, 132, 138, 142, 148, 152, 156, 160, 163,
+            166, 170, 173, 174, 178, 181, 184, 186, 189, 190, 194, 196, 198, 200, 202, 205,
+            206, 209, 211, 214, 216, 218, 220, 222, 224, 225, 227, 229, 230, 232, 233, 235,
+            237, 238, 240, 241, 242, 243, 244, 246, 246, 248, 249, 250, 251, 252, 253, 254
+        };
+        for (int velocity = 0; velocity < DX7::kNumMIDINotes; ++velocity) {
+            int value = kVelocityData[velocity >> 1] - 239;
+            int scaled = ((velocitySensitivity_ * value + 7) >> 3) << 4;
+            velocityGain_[velocity] = levelStepsToGain(static_cast<float>(scaled) / 32.0f);
+        }
+    }
+
+    void rebuildRateTable() {
+        for (int group = 0; group < DX7::kRateScalingGroups; ++group) {
+            // Dexed adds (sensitivity * group) >> 3 to the 0-63 internal rate;
+            // convert back to the 0-99 range used by the envelope
+            float rateDelta = static_cast<float>((rateScaling_ * group) >> 3) * 99.0f / 63.0f;
+            for (int stage = 0; stage < DX7::kEnvelopeStages; ++stage) {
+                float rate = std::min(rates_[stage] + rateDelta, DX7::kEnvelopeMaxRate);
+                rateCoefficients_[group][stage] = Envelope::rateToCoefficient(rate, sampleRate_);
+            }
+        }
+    }
+
+    float sampleRate_ = 44100.0f;
+    std::array<float, DX7::kEnvelopeStages> rates_ = {99.0f, 75.0f, 50.0f, 50.0f};
+    int breakPoint_ = 39;
+    int leftDepth_ = 0;
+    int rightDepth_ = 0;
+    ScalingCurve leftCurve_ = ScalingCurve::NegativeLinear;
+    ScalingCurve rightCurve_ = ScalingCurve::NegativeLinear;
+    int rateScaling_ = 0;
+    int velocitySensitivity_ = 0;
+
+    std::array<float, DX7::kNumMIDINotes> levelGain_{};
+    std::array<float, DX7::kNumMIDINotes> velocityGain_{};
+    std::array<EnvelopeCoefficients, DX7::kRateScalingGroups> rateCoefficients_{};
+};
+
+} // namespace M2DX
+
+#endif /* OperatorScaling_hpp */
@@ -0,0 +1,119 @@
+#ifndef ParameterRamp_hpp
+#define ParameterRamp_hpp
+
+#include <cmath>
+#include <cstdint>
+
+namespace M2DX {
+
+/// Interpolation curve for a parameter ramp segment
+enum class RampShape : uint8_t {
+    Linear,      // Constant step per frame
+    Exponential  // Constant ratio per frame (falls back to linear across zero)
+};
+
+/// Complete state of a ramp segment in progress (see ParameterRamp::restore())
+struct ParameterRampState {
+    float current = 0.0f;
+    float target = 0.0f;
+    float step = 0.0f;        // Per-frame step; log-domain step for exponential segments
+    float logCurrent = 0.0f;  // Exponential segments only
+    int remainingFrames = 0;
+    bool exponential = false;
+};
+
+/// Smoothed parameter value driven by linear or exponential ramp segments
+///
+/// Ramps are advanced in blocks of frames rather than per sample.
+/// The kernel reads the value at each block boundary and pushes it to the voices,
+/// so a ramp costs one update per block regardless of how many voices are playing.
+class ParameterRamp {
+public:
+    /// Jump to a value immediately and cancel any ramp in progress
+    void reset(float value) {
+        current_ = value;
+        target_ = value;
+        remainingFrames_ = 0;
+    }
+
+    /// Start a new segment from the current value
+    /// @param target Value reached at the end of the segment
+    /// @param durationFrames Segment length in frames (<= 0 jumps immediately)
+    /// @param shape Interpolation curve
+    void start(float target, int durationFrames, RampShape shape) {
+        if (durationFrames <= 0 || target == current_) {
+            reset(target);
+            return;
+        }
+
+        target_ = target;
+        remainingFrames_ = durationFrames;
+
+        // Exponential segments need both endpoints on the same side of zero
+        exponential_ = shape == RampShape::Exponential && current_ * target > 0.0f;
+        if (exponential_) {
+            logCurrent_ = std::log(std::abs(current_));
+            logStep_ = (std::log(std::abs(target)) - logCurrent_) / static_cast<float>(durationFrames);
+        } else {
+            step_ = (target - current_) / static_cast<float>(durationFrames);
+        }
+    }
+
+    /// Advance the ramp
+    /// @param frames Number of frames elapsed
+    /// @return Value after advancing
+    float advance(int frames) {
+        if (remainingFrames_ <= 0) return current_;
+
+        if (frames >= remainingFrames_) {
+            reset(target_);
+            return current_;
+        }
+
+        remainingFrames_ -= frames;
+        if (exponential_) {
+            logCurrent_ += logStep_ * static_cast<float>(frames);
+            current_ = std::copysign(std::exp(logCurrent_), target_);
+        } else {
+            current_ += step_ * static_cast<float>(frames);
+        }
+        return current_;
+    }
+
+    /// Capture the segment so it can be resumed bit for bit (event trace snapshots)
+    ParameterRampState getState() const {
+        return {current_, target_, exponential_ ? logStep_ : step_, logCurrent_,
+                remainingFrames_, exponential_};
+    }
+
+    void restore(const ParameterRampState& state) {
+        current_ = state.current;
+        target_ = state.target;
+        logCurrent_ = state.logCurrent;
+        remainingFrames_ = state.remainingFrames;
+        exponential_ = state.exponential;
+        if (exponential_) {
+            logStep_ = state.step;
+        } else {
+            step_ = state.step;
+        }
+    }
+
+    bool isRamping() const { return remainingFrames_ > 0; }
+    int getRemainingFrames() const { return remainingFrames_; }
+    float getValue() const { return current_; }
+    float getTarget() const { return target_; }
+
+private:
+    float current_ = 0.0f;
+    float target_ = 0.0f;
+    float step_ = 0.0f;
+    float logCurrent_ = 0.0f;
+    float logStep_ = 0.0f;
+    int remainingFrames_ = 0;
+    bool exponential_ = false;
+};
+
+} // namespace M2DX
+
+#endif /* ParameterRamp_hpp */
@@ -0,0 +1,122 @@
+#ifndef TraceWriter_hpp
+#define TraceWriter_hpp
+
+#include "EventTrace.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace M2DX {
+
+/// Background thread that drains a TraceRecorder into a trace file
+/// All encoding and file I/O happens on the writer thread.
+class TraceWriter {
+public:
+    explicit TraceWriter(TraceRecorder& recorder) : recorder_(recorder) {}
+
+    ~TraceWriter() { stop(); }
+
+    TraceWriter(const TraceWriter&) = delete;
+    TraceWriter& operator=(const TraceWriter&) = delete;
+
+    /// Create the trace file and start the writer thread
+    /// @return false if already running or the file cannot be created
+    bool start(const std::string& path) {
+        if (running_.load()) return false;
+
+        file_ = std::fopen(path.c_str(), "wb");
+        if (!file_) return false;
+
+        // Leftovers from an earlier session must not precede this file's snapshot
+        recorder_.clear();
+
+        writeError_.store(false);
+        encoder_ = TraceEncoder{};
+        buffer_.clear();
+        TraceEncoder::appendHeader(buffer_);
+        flushBuffer();
+
+        running_.store(true);
+        thread_ = std::thread([this] { run(); });
+        return true;
+    }
+
+    /// Drain the recorder, close the file and join the thread
+    void stop() {
+        if (!running_.exchange(false)) return;
+        if (thread_.joinable()) thread_.join();
+    }
+
+    bool isRunning() const { return running_.load(); }
+    bool hasWriteError() const { return writeError_.load(); }
+    uint64_t getEventsWritten() const { return eventsWritten_.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr size_t kFlushBytes = 16384;
+
+    void run() {
+        auto lastFlush = std::chrono::steady_clock::now();
+        TraceEvent event;
+
+        while (true) {
+            bool stopping = !running_.load();
+            bool drained = true;
+
+            while (recorder_.pop(event)) {
+                encoder_.append(event, buffer_);
+                eventsWritten_.fetch_add(1, std::memory_order_relaxed);
+                if (buffer_.size() >= kFlushBytes) {
+                    flushBuffer();
+                    drained = false;
+                    break;
+                }
+            }
+
+            auto now = std::chrono::steady_clock::now();
+            if (now - lastFlush >= std::chrono::seconds(1)) {
+                flushBuffer();
+                if (file_) std::fflush(file_);
+                lastFlush = now;
+            }
+
+            if (drained) {
+                if (stopping) break;
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+        }
+
+        flushBuffer();
+        if (file_) {
+            std::fclose(file_);
+            file_ = nullptr;
+        }
+    }
+
+    void flushBuffer() {
+        if (file_ && !buffer_.empty() &&
+            std::fwrite(buffer_.data(), 1, buffer_.size(), file_) != buffer_.size()) {
+            writeError_.store(true);
+            std::fclose(file_);
+            file_ = nullptr;
+        }
+        buffer_.clear();
+    }
+
+    TraceRecorder& recorder_;
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    std::atomic<bool> writeError_{false};
+    std::atomic<uint64_t> eventsWritten_{0};
+
+    // Writer thread state
+    std::FILE* file_ = nullptr;
+    TraceEncoder encoder_;
+    std::vector<uint8_t> buffer_;
+};
+
+} // namespace M2DX
+
+#endif /* TraceWriter_hpp */
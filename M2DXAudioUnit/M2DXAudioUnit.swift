@@ -128,10 +128,16 @@ public class M2DXAudioUnit: AUAudioUnit {
 
         return { actionFlags, timestamp, frameCount, outputBusNumber, outputData, realtimeEventListHead, pullInputBlock in
 
-            // Handle MIDI events
+            // Handle MIDI and parameter events
+            let bufferStartTime = AUEventSampleTime(timestamp.pointee.mSampleTime)
             var nextEvent: UnsafePointer<AURenderEvent>? = realtimeEventListHead
             while let event = nextEvent {
-                Self.handleMIDIEventStatic(event, kernel: kernel)
+                switch event.pointee.head.eventType {
+                case .parameter, .parameterRamp:
+                    Self.handleParameterEventStatic(event, bufferStartTime: bufferStartTime, frameCount: frameCount, kernel: kernel)
+                default:
+                    Self.handleMIDIEventStatic(event, kernel: kernel)
+                }
                 nextEvent = UnsafePointer(event.pointee.head.next)
             }
 
@@ -196,6 +202,19 @@ public class M2DXAudioUnit: AUAudioUnit {
         }
     }
 
+    /// Forward host automation to the kernel as sample-accurate ramps
+    /// Parameters the kernel cannot ramp (algorithm, feedback, EG) are applied
+    /// immediately at the start of the buffer instead
+    private static func handleParameterEventStatic(_ eventPtr: UnsafePointer<AURenderEvent>, bufferStartTime: AUEventSampleTime, frameCount: AUAudioFrameCount, kernel: M2DXKernelBridge) {
+        let event = eventPtr.pointee.parameter
+        let address = Int32(clamping: event.parameterAddress)
+        let offset = max(0, min(event.eventSampleTime - bufferStartTime, AUEventSampleTime(frameCount) - 1))
+        let duration = event.eventType == .parameterRamp ? Int32(clamping: event.rampDurationSampleFrames) : 0
+        if !kernel.scheduleParameterRamp(address, target: event.value, frameOffset: Int32(offset), durationFrames: duration) {
+            _ = kernel.setParameter(address, value: event.value)
+        }
+    }
+
     private static func handleControlChangeStatic(controller: UInt8, value: UInt8, kernel: M2DXKernelBridge) {
         switch controller {
         case 1: // Modulation wheel